@@ -0,0 +1,406 @@
+/*
+ * alarm.c - alarm clock.
+ *
+ *   The alarms come from the configuration and the control fifo,
+ *   the ones of the fifo are kept in a state file across restarts.
+ *   One loop timer runs on the next deadline : the next ring or the
+ *   end of the ringing, nothing is polled in between.
+ *
+ *   "alarms" : [ { "time": "07:30", "days": "1-5", "duration": 120 } ]
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+
+#include <alarm.h>
+#include <strmem.h>
+#include <jsonroot.h>
+#include <duprintf.h>
+
+/* the alarm timer is idle this long when no alarm is set */
+#define ALARM_IDLE_SEC 3600
+
+/*
+ * local prototypes
+ */
+int alarm_parse_days( const char *str );
+time_t alarm_next_time( Alarm *a, time_t now );
+void alarm_arm( VfddAlarms *al );
+void alarm_changed( VfddAlarms *al );
+void alarm_load( VfddAlarms *al );
+void alarm_save( VfddAlarms *al );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddAlarms object.
+ *  notify : queue of the text flashed while ringing
+ *  state_dir : dir of the state file, NULL not to keep the alarms
+ */
+
+VfddAlarms *alarm_new( Loop *loop, VfddNotify *notify, const char *state_dir )
+{
+   VfddAlarms *al;
+
+   al =  app_new0(VfddAlarms, 1);
+   alarm_construct( al, loop, notify, state_dir );
+   app_class_overload_destroy( (AppClass *) al, alarm_destroy );
+   return al;
+}
+
+/** \brief Constructor for the VfddAlarms object. */
+
+void alarm_construct( VfddAlarms *al, Loop *loop, VfddNotify *notify,
+		      const char *state_dir )
+{
+   app_class_construct( (AppClass *) al );
+
+   al->notify = notify;
+   al->text = app_strdup( ALARM_TEXT );
+   al->timer = timer_new( (AppClass *) al, ALARM_IDLE_SEC * 1000,
+			  alarm_timer_cb, NULL );
+   loop_timer_add( loop, al->timer );
+   if ( state_dir ){
+      al->state = app_strdup_printf( "%s/%s", state_dir, ALARM_STATE );
+      alarm_load( al );
+   }
+   alarm_arm( al );
+}
+
+/** \brief Destructor for the VfddAlarms object.
+ *  the timer belongs to the loop */
+
+void alarm_destroy(void *al)
+{
+   VfddAlarms *this = (VfddAlarms *) al;
+
+   if (al == NULL) {
+      return;
+   }
+   app_free(this->state);
+   app_free(this->text);
+
+   app_class_destroy( al );
+}
+
+void alarm_set_changed_func( VfddAlarms *al, App_Run_FP func, void *user_data )
+{
+   al->changed_func = func;
+   al->changed_app = user_data;
+}
+
+void alarm_changed( VfddAlarms *al )
+{
+   if ( al->changed_func ){
+      al->changed_func( al->changed_app, al );
+   }
+}
+
+/*
+ * "1-5", "0,6", "*" : week days as in cron, 0 or 7 sunday,
+ * return the mask or -1
+ */
+int alarm_parse_days( const char *str )
+{
+   const char *p = str;
+   int days = 0;
+
+   if ( ! str || strcmp( str, "*" ) == 0 ){
+      return ALARM_EVERY_DAY;
+   }
+   while ( *p ){
+      char *end;
+      int from = strtol( p, &end, 10 );
+      int to = from;
+
+      if ( end == p ){
+	 return -1;
+      }
+      p = end;
+      if ( *p == '-' ){
+	 to = strtol( ++p, &end, 10 );
+	 if ( end == p ){
+	    return -1;
+	 }
+	 p = end;
+      }
+      if ( from < 0 || to > 7 || from > to ){
+	 return -1;
+      }
+      for ( ; from <= to ; from++ ){
+	 days |= 1 << ( from % 7 );
+      }
+      if ( *p == ',' ){
+	 p++;
+      } else if ( *p ){
+	 return -1;
+      }
+   }
+   return days;
+}
+
+/*
+ * the first local time after now the alarm rings, 0 if never
+ */
+time_t alarm_next_time( Alarm *a, time_t now )
+{
+   struct tm today;
+   int d;
+
+   localtime_r( &now, &today );
+   for ( d = 0 ; d <= 7 ; d++ ){
+      struct tm tm = today;
+      time_t t;
+
+      tm.tm_mday += d;
+      tm.tm_hour = a->hour;
+      tm.tm_min = a->min;
+      tm.tm_sec = 0;
+      tm.tm_isdst = -1;
+      t = mktime( &tm );
+      if ( t > now && ( a->days & ( 1 << tm.tm_wday ) ) ){
+	 return t;
+      }
+   }
+   return 0;
+}
+
+/*
+ * run the timer on the next ring or the end of the ringing
+ */
+void alarm_arm( VfddAlarms *al )
+{
+   struct timeval when;
+   time_t now;
+   int i;
+
+   gettimeofday( &when, NULL );
+   now = when.tv_sec;
+   when.tv_sec += ALARM_IDLE_SEC;
+   when.tv_usec = 0;
+
+   al->next = 0;
+   for ( i = 0 ; i < al->num ; i++ ){
+      time_t t = alarm_next_time( &al->alarms[i], now );
+      if ( t && ( ! al->next || t < al->next ) ){
+	 al->next = t;
+	 al->next_duration = al->alarms[i].duration;
+      }
+   }
+   if ( al->next && al->next < when.tv_sec ){
+      when.tv_sec = al->next;
+   }
+   if ( al->ring_end && al->ring_end < when.tv_sec ){
+      when.tv_sec = al->ring_end;
+   }
+   timer_set_when( al->timer, &when );
+}
+
+/*
+ * hhmm : "HH:MM", days : see alarm_parse_days, duration : secs
+ * conf : 1 if from the configuration, it is not saved
+ * return the alarm index or -1
+ */
+int alarm_add( VfddAlarms *al, const char *hhmm, const char *days, int duration, int conf )
+{
+   Alarm *a;
+   int hour, min, mask;
+
+   if ( ! hhmm || sscanf( hhmm, "%d:%d", &hour, &min ) != 2 ||
+	hour < 0 || hour > 23 || min < 0 || min > 59 ){
+      msg_error( "alarm time '%s' is not HH:MM", hhmm ? hhmm : "" );
+      return -1;
+   }
+   mask = alarm_parse_days( days );
+   if ( mask <= 0 ){
+      msg_error( "alarm days '%s' are not week days", days );
+      return -1;
+   }
+   if ( al->num >= ALARM_MAX ){
+      msg_error( "%d alarms set, %s dropped", ALARM_MAX, hhmm );
+      return -1;
+   }
+   a = &al->alarms[al->num];
+   a->hour = hour;
+   a->min = min;
+   a->days = mask;
+   a->duration = duration > 0 ? duration : ALARM_DURATION;
+   a->conf = conf;
+   al->num++;
+   if ( ! conf ){
+      alarm_save( al );
+   }
+   alarm_arm( al );
+   alarm_changed( al );
+   return al->num - 1;
+}
+
+/*
+ * remove alarm idx, return -1 if there is none or it is from the
+ * configuration : it would come back on the next start
+ */
+int alarm_del( VfddAlarms *al, int idx )
+{
+   if ( idx < 0 || idx >= al->num ){
+      msg_error( "no alarm %d", idx );
+      return -1;
+   }
+   if ( al->alarms[idx].conf ){
+      msg_error( "alarm %d is set in the configuration, remove it there", idx );
+      return -1;
+   }
+   memmove( &al->alarms[idx], &al->alarms[idx + 1],
+	    ( al->num - idx - 1 ) * sizeof(Alarm) );
+   al->num--;
+   alarm_save( al );
+   alarm_arm( al );
+   alarm_changed( al );
+   return 0;
+}
+
+/*
+ * stop the ringing
+ */
+void alarm_stop( VfddAlarms *al )
+{
+   if ( ! al->ring_end ){
+      return;
+   }
+   notify_cancel( al->notify, al->ring_seq );
+   al->ring_end = 0;
+   al->ring_seq = 0;
+   alarm_arm( al );
+   alarm_changed( al );
+}
+
+void alarm_list( VfddAlarms *al )
+{
+   int i;
+
+   for ( i = 0 ; i < al->num ; i++ ){
+      Alarm *a = &al->alarms[i];
+      msg_info( "alarm %d : %02d:%02d days 0x%02x %d secs%s", i, a->hour, a->min,
+		a->days, a->duration, a->conf ? " (configuration)" : "" );
+   }
+   if ( al->next ){
+      msg_info( "next alarm in %ld secs", (long) ( al->next - time( NULL ) ) );
+   }
+}
+
+int alarm_ringing( VfddAlarms *al )
+{
+   return al->ring_end != 0;
+}
+
+/*
+ * a deadline : the ringing ends or an alarm rings
+ */
+int alarm_timer_cb( AppClass *xal, AppClass *user_data )
+{
+   VfddAlarms *al = (VfddAlarms *) xal;
+   struct timeval tv;
+   int changed = 0;
+
+   /* the loop runs the timer on gettimeofday, time() may lag behind */
+   gettimeofday( &tv, NULL );
+   time_t now = tv.tv_sec;
+
+   if ( al->ring_end && now >= al->ring_end ){
+      /* the notification expires on its own */
+      al->ring_end = 0;
+      al->ring_seq = 0;
+      changed = 1;
+   }
+   if ( al->next && now >= al->next ){
+      msg_info( "alarm ringing for %d secs", al->next_duration );
+      notify_cancel( al->notify, al->ring_seq );
+      al->ring_end = now + al->next_duration;
+      /* 0 : the queue is full, only the dot led rings and there is nothing to cancel */
+      al->ring_seq = notify_push( al->notify, ALARM_PRIORITY,
+				  al->next_duration * 1000, al->text, 1 );
+      if ( al->ring_seq == 0 ){
+	 msg_warning( "alarm text '%s' not shown", al->text );
+      }
+      changed = 1;
+   }
+   alarm_arm( al );
+   if ( changed ){
+      alarm_changed( al );
+   }
+   return 0;
+}
+
+/*
+ * one alarm per line : HH:MM days-mask duration
+ */
+void alarm_load( VfddAlarms *al )
+{
+   char line[64];
+   FILE *fp = fopen( al->state, "r" );
+   Alarm a;
+
+   if ( ! fp ){
+      return;
+   }
+   while ( fgets( line, sizeof(line), fp ) && al->num < ALARM_MAX ){
+      if ( sscanf( line, "%d:%d %d %d", &a.hour, &a.min, &a.days, &a.duration ) == 4 &&
+	   a.hour >= 0 && a.hour < 24 && a.min >= 0 && a.min < 60 &&
+	   ( a.days & ALARM_EVERY_DAY ) && a.duration > 0 ){
+	 a.days &= ALARM_EVERY_DAY;
+	 a.conf = 0;
+	 al->alarms[al->num++] = a;
+      }
+   }
+   fclose( fp );
+   msg_dbg( "%d alarms from '%s'", al->num, al->state );
+}
+
+void alarm_save( VfddAlarms *al )
+{
+   char *tmp;
+   FILE *fp;
+   int i;
+
+   if ( ! al->state ){
+      return;
+   }
+   /* a crash while writing leaves the old alarms */
+   tmp = app_strdup_printf( "%s.tmp", al->state );
+   fp = fopen( tmp, "w" );
+   if ( ! fp ){
+      msg_error( "Failed to open file '%s' - %s", tmp, strerror(errno) );
+      app_free(tmp);
+      return;
+   }
+   for ( i = 0 ; i < al->num ; i++ ){
+      Alarm *a = &al->alarms[i];
+      if ( ! a->conf ){
+	 fprintf( fp, "%02d:%02d %d %d\n", a->hour, a->min, a->days, a->duration );
+      }
+   }
+   if ( fclose( fp ) || rename( tmp, al->state ) < 0 ){
+      msg_error( "Failed to write file '%s' - %s", al->state, strerror(errno) );
+   }
+   app_free(tmp);
+}
+
+/*
+ * { "time": "07:30", "days": "1-5", "duration": 120 }
+ */
+int alarm_iter_conf( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   VfddAlarms *al = (VfddAlarms *) user_data;
+   char *hhmm;
+   char *days;
+   int duration;
+
+   json_root_get_item_string( node, "time", &hhmm );
+   json_root_get_item_string( node, "days", &days );
+   json_root_get_item_int( node, "duration", &duration );
+   alarm_add( al, hhmm, days, duration, 1 );
+   return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef ALARM_H
+#define ALARM_H
+
+/*
+ * alarm.h - alarm clock : alarms on a time of some week days,
+ *           ringing on the dotled and a flashing notification
+ *
+ * include LICENSE
+ */
+
+#include <time.h>
+
+#include <loop.h>
+#include <timerms.h>
+#include <notify.h>
+
+#define ALARM_MAX       16      /* alarms in the table */
+#define ALARM_DURATION  60      /* default secs an alarm rings */
+#define ALARM_PRIORITY  100     /* notification priority of a ringing alarm */
+#define ALARM_TEXT      "ALAr"  /* default text flashed while ringing */
+#define ALARM_STATE     "alarms"  /* state file in the state dir */
+#define ALARM_EVERY_DAY 0x7f
+
+typedef struct _Alarm Alarm;
+
+struct _Alarm {
+   int hour;
+   int min;
+   int days;                    /* bit 0 sunday to bit 6 saturday */
+   int duration;                /* secs it rings */
+   int conf;                    /* 1 if from the configuration, not saved */
+};
+
+typedef struct _VfddAlarms VfddAlarms;
+
+struct _VfddAlarms {
+   AppClass parent;
+   Timer *timer;                /* runs on the next ring or ring end */
+   VfddNotify *notify;          /* queue of the flashing text */
+   char *state;                 /* state file, NULL if none */
+   char *text;                  /* text flashed while ringing */
+   Alarm alarms[ALARM_MAX];
+   int num;
+   time_t next;                 /* time of the next ring, 0 if none */
+   int next_duration;           /* secs of the next ring */
+   time_t ring_end;             /* end of the ring, 0 if not ringing */
+   unsigned long ring_seq;      /* notification of the ring, 0 if not queued */
+   App_Run_FP changed_func;     /* called when the ringing starts or stops */
+   void *changed_app;
+};
+
+/*
+ * prototypes
+ */
+VfddAlarms *alarm_new( Loop *loop, VfddNotify *notify, const char *state_dir );
+void alarm_construct( VfddAlarms *al, Loop *loop, VfddNotify *notify,
+		      const char *state_dir );
+void alarm_destroy(void *al);
+
+void alarm_set_changed_func( VfddAlarms *al, App_Run_FP func, void *user_data );
+int alarm_add( VfddAlarms *al, const char *hhmm, const char *days, int duration, int conf );
+int alarm_del( VfddAlarms *al, int idx );
+void alarm_stop( VfddAlarms *al );
+void alarm_list( VfddAlarms *al );
+int alarm_ringing( VfddAlarms *al );
+int alarm_timer_cb( AppClass *xal, AppClass *user_data );
+int alarm_iter_conf( AppClass *data, void *user_data );
+
+#endif /* ALARM_H */
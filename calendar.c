@@ -0,0 +1,105 @@
+/*
+ * calendar.c - broken-down local time kept for the current minute.
+ *
+ *   Within a minute only the seconds change : they are the offset
+ *   from the start of the minute. localtime_r runs on a minute
+ *   rollover, on a clock step, or when the time zone file changes.
+ *   A daylight saving change always falls on a minute start.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <calendar.h>
+#include <strmem.h>
+
+/*
+ * local prototypes
+ */
+int calendar_zone_changed( VfddCalendar *cal );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddCalendar object.
+ */
+
+VfddCalendar *calendar_new( void )
+{
+   VfddCalendar *cal;
+
+   cal =  app_new0(VfddCalendar, 1);
+   calendar_construct( cal );
+   app_class_overload_destroy( (AppClass *) cal, calendar_destroy );
+   return cal;
+}
+
+/** \brief Constructor for the VfddCalendar object. */
+
+void calendar_construct( VfddCalendar *cal )
+{
+   app_class_construct( (AppClass *) cal );
+
+   cal->minute = -1;
+   calendar_zone_changed( cal );
+   tzset();
+}
+
+/** \brief Destructor for the VfddCalendar object. */
+
+void calendar_destroy(void *cal)
+{
+   VfddCalendar *this = (VfddCalendar *) cal;
+
+   if (cal == NULL) {
+      return;
+   }
+   msg_dbg( "calendar %lu localtime calls %lu from minute offset",
+	    this->recomputes, this->offsets );
+
+   app_class_destroy( cal );
+}
+
+/*
+ * return 1 if the zone file is not the one seen last time
+ */
+int calendar_zone_changed( VfddCalendar *cal )
+{
+   struct stat st;
+
+   if ( stat( CALENDAR_ZONE_FILE, &st ) < 0 ){
+      memset( &st, 0, sizeof(st) );
+   }
+   if ( st.st_mtime == cal->zone_mtime && st.st_ino == cal->zone_ino ){
+      return 0;
+   }
+   cal->zone_mtime = st.st_mtime;
+   cal->zone_ino = st.st_ino;
+   return 1;
+}
+
+/*
+ * set tm to the local time of t
+ */
+void calendar_get( VfddCalendar *cal, time_t t, struct tm *tm )
+{
+   if ( t >= cal->zone_check ){
+      cal->zone_check = t + CALENDAR_ZONE_CHECK;
+      if ( calendar_zone_changed( cal ) ){
+	 /* localtime_r does not read the zone file again by itself */
+	 tzset();
+	 cal->minute = -1;
+	 msg_info( "time zone changed" );
+      }
+   }
+   if ( cal->minute < 0 || t < cal->minute || t >= cal->minute + 60 ){
+      localtime_r( &t, &cal->tm );
+      cal->minute = t - cal->tm.tm_sec;
+      cal->recomputes++;
+   } else {
+      cal->offsets++;
+   }
+   *tm = cal->tm;
+   tm->tm_sec = t - cal->minute;
+}
@@ -0,0 +1,40 @@
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+/*
+ * calendar.h - broken-down local time kept for the current minute
+ *
+ * include LICENSE
+ */
+
+#include <time.h>
+#include <sys/types.h>
+
+#include <appclass.h>
+
+#define CALENDAR_ZONE_FILE  "/etc/localtime"
+#define CALENDAR_ZONE_CHECK 10          /* seconds between zone file checks */
+
+typedef struct _VfddCalendar VfddCalendar;
+
+struct _VfddCalendar {
+   AppClass parent;
+   time_t minute;               /* start of the minute of tm, -1 if none */
+   struct tm tm;                /* local time at minute */
+   time_t zone_check;           /* next time the zone file is checked */
+   time_t zone_mtime;           /* zone file modification time */
+   ino_t zone_ino;              /* zone file inode, replaced on update */
+   unsigned long recomputes;    /* calls to localtime_r */
+   unsigned long offsets;       /* times given from minute */
+};
+
+/*
+ * prototypes
+ */
+VfddCalendar *calendar_new( void );
+void calendar_construct( VfddCalendar *cal );
+void calendar_destroy(void *cal);
+
+void calendar_get( VfddCalendar *cal, time_t t, struct tm *tm );
+
+#endif /* CALENDAR_H */
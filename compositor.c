@@ -0,0 +1,163 @@
+/*
+ * compositor.c - display words built from independent layers.
+ *
+ *   Each layer keeps its own words. Writing a word that changes marks
+ *   it dirty and only dirty words are ORed again from the visible
+ *   layers : a dotled flip recomposes one word, an unchanged clock
+ *   recomposes nothing.
+ *
+ * include LICENSE
+ */
+#include <string.h>
+
+#include <compositor.h>
+#include <strmem.h>
+
+/*
+ *** \brief Allocates memory for a new VfddCompositor object.
+ *  words : number of display words
+ *  frame : the words receiving the composition
+ */
+
+VfddCompositor *compositor_new( int words, uint16_t *frame )
+{
+   VfddCompositor *co;
+
+   co =  app_new0(VfddCompositor, 1);
+   compositor_construct( co, words, frame );
+   app_class_overload_destroy( (AppClass *) co, compositor_destroy );
+   return co;
+}
+
+/** \brief Constructor for the VfddCompositor object. */
+
+void compositor_construct( VfddCompositor *co, int words, uint16_t *frame )
+{
+   int i;
+
+   app_class_construct( (AppClass *) co );
+
+   if ( words > COMPOSITOR_MAX_WORDS ){
+      msg_error( "%d display words, only %d are used", words, COMPOSITOR_MAX_WORDS );
+      words = COMPOSITOR_MAX_WORDS;
+   }
+   co->words = words;
+   co->frame = frame;
+   for ( i = 0 ; i < LAYER_NUM ; i++ ){
+      co->layers[i].raw = app_new0( uint16_t, words );
+      co->layers[i].visible = 1;
+   }
+   /* the first composition writes every word */
+   co->dirty = ~0ULL;
+}
+
+/** \brief Destructor for the VfddCompositor object. */
+
+void compositor_destroy(void *co)
+{
+   VfddCompositor *this = (VfddCompositor *) co;
+   int i;
+
+   if (co == NULL) {
+      return;
+   }
+   msg_dbg( "compositor %lu compositions %lu words changed",
+	    this->composes, this->changes );
+   for ( i = 0 ; i < LAYER_NUM ; i++ ){
+      app_free(this->layers[i].raw);
+   }
+
+   app_class_destroy( co );
+}
+
+void compositor_set_word( VfddCompositor *co, int layer, int n, uint16_t val )
+{
+   CompositorLayer *la = &co->layers[layer];
+
+   if ( n < 0 || n >= co->words || la->raw[n] == val ){
+      return;
+   }
+   la->raw[n] = val;
+   if ( val ){
+      la->used |= 1ULL << n;
+   } else {
+      la->used &= ~(1ULL << n);
+   }
+   if ( la->visible ){
+      co->dirty |= 1ULL << n;
+   }
+}
+
+void compositor_set_bit( VfddCompositor *co, int layer, int n, int bit, int on )
+{
+   if ( n < 0 || n >= co->words ){
+      return;
+   }
+   uint16_t val = co->layers[layer].raw[n];
+   if ( on ){
+      val |= 1 << bit;
+   } else {
+      val &= ~(1 << bit);
+   }
+   compositor_set_word( co, layer, n, val );
+}
+
+/*
+ * replace the words of the layer, only the changed ones are dirty
+ */
+void compositor_set_words( VfddCompositor *co, int layer, const uint16_t *raw )
+{
+   int n;
+
+   for ( n = 0 ; n < co->words ; n++ ){
+      compositor_set_word( co, layer, n, raw[n] );
+   }
+}
+
+/*
+ * show or hide a layer, the words it holds are composited again
+ */
+void compositor_show_layer( VfddCompositor *co, int layer, int visible )
+{
+   CompositorLayer *la = &co->layers[layer];
+
+   if ( la->visible == visible ){
+      return;
+   }
+   la->visible = visible;
+   co->dirty |= la->used;
+}
+
+/*
+ * OR the visible layers into the frame words that are dirty,
+ * return the number of frame words changed
+ */
+int compositor_compose( VfddCompositor *co )
+{
+   int changed = 0;
+   int n, i;
+
+   if ( ! co->dirty ){
+      return 0;
+   }
+   /* the first composition counts every word as changed */
+   int first = ( co->composes++ == 0 );
+   for ( n = 0 ; n < co->words ; n++ ){
+      if ( ! ( co->dirty & (1ULL << n) ) ){
+	 continue;
+      }
+      uint16_t val = 0;
+      for ( i = 0 ; i < LAYER_NUM ; i++ ){
+	 if ( co->layers[i].visible ){
+	    val |= co->layers[i].raw[n];
+	 }
+      }
+      if ( co->frame[n] != val || first ){
+	 co->frame[n] = val;
+	 changed++;
+      }
+   }
+   co->dirty = 0;
+   co->changes += changed;
+   return changed;
+}
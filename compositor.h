@@ -0,0 +1,58 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+/*
+ * compositor.h - display words built from independent layers,
+ *                ORed together where a layer has changed.
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+
+#include <appclass.h>
+
+#define COMPOSITOR_MAX_WORDS 64     /* display words, one dirty bit each */
+
+enum _CompositorLayerIndex {
+   LAYER_TEXT,       /* the laid out string and its colon */
+   LAYER_NOTIFY,     /* notification overlay */
+   LAYER_DOTLED,     /* dotleds */
+   LAYER_BLINK,      /* blinking segments, shown every other phase */
+   LAYER_NUM,
+};
+
+typedef struct _CompositorLayer CompositorLayer;
+
+struct _CompositorLayer {
+   uint16_t *raw;          /* words of the layer */
+   uint64_t used;          /* bit n set if raw[n] is not 0 */
+   int visible;            /* 1 if the layer is composited */
+};
+
+typedef struct _VfddCompositor VfddCompositor;
+
+struct _VfddCompositor {
+   AppClass parent;
+   int words;              /* number of display words */
+   uint16_t *frame;        /* the composited words */
+   CompositorLayer layers[LAYER_NUM];
+   uint64_t dirty;         /* bit n set if word n must be composited again */
+   unsigned long composes; /* compositions with a dirty word */
+   unsigned long changes;  /* frame words changed */
+};
+
+/*
+ * prototypes
+ */
+VfddCompositor *compositor_new( int words, uint16_t *frame );
+void compositor_construct( VfddCompositor *co, int words, uint16_t *frame );
+void compositor_destroy(void *co);
+
+void compositor_set_word( VfddCompositor *co, int layer, int n, uint16_t val );
+void compositor_set_bit( VfddCompositor *co, int layer, int n, int bit, int on );
+void compositor_set_words( VfddCompositor *co, int layer, const uint16_t *raw );
+void compositor_show_layer( VfddCompositor *co, int layer, int visible );
+int compositor_compose( VfddCompositor *co );
+
+#endif /* COMPOSITOR_H */
@@ -0,0 +1,260 @@
+/*
+ * control.c - commands read from a fifo, one per line :
+ *
+ *   echo "notify 5 10 CALL" > /run/vfdd.ctl
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <control.h>
+#include <strmem.h>
+
+/*
+ * local prototypes
+ */
+int control_cmd_notify( VfddControl *ctl, char *args );
+int control_cmd_clear( VfddControl *ctl, char *args );
+int control_cmd_stats( VfddControl *ctl, char *args );
+int control_cmd_alarm( VfddControl *ctl, char *args );
+int control_cmd_unalarm( VfddControl *ctl, char *args );
+int control_cmd_alarms( VfddControl *ctl, char *args );
+int control_cmd_stop( VfddControl *ctl, char *args );
+/* */
+
+static const ControlCmd control_cmds[] = {
+   { "notify", control_cmd_notify, "notify <priority> <ttl secs> <text>" },
+   { "clear", control_cmd_clear, "clear" },
+   { "stats", control_cmd_stats, "stats" },
+   { "alarm", control_cmd_alarm, "alarm <HH:MM> [days] [ring secs]" },
+   { "unalarm", control_cmd_unalarm, "unalarm <alarm number>" },
+   { "alarms", control_cmd_alarms, "alarms" },
+   { "stop", control_cmd_stop, "stop" },
+   { NULL, NULL, NULL },
+};
+
+/*
+ *** \brief Allocates memory for a new VfddControl object.
+ *  path : the fifo, created if it does not exist
+ */
+
+VfddControl *control_new( Loop *loop, const char *path, VfddNotify *notify )
+{
+   VfddControl *ctl;
+
+   ctl =  app_new0(VfddControl, 1);
+   control_construct( ctl, loop, path, notify );
+   app_class_overload_destroy( (AppClass *) ctl, control_destroy );
+   return ctl;
+}
+
+/** \brief Constructor for the VfddControl object. */
+
+void control_construct( VfddControl *ctl, Loop *loop, const char *path,
+			VfddNotify *notify )
+{
+   app_class_construct( (AppClass *) ctl );
+
+   ctl->loop = loop;
+   ctl->notify = notify;
+   ctl->path = app_strdup( path );
+   ctl->fd = -1;
+
+   if ( mkfifo( path, 0620 ) < 0 && errno != EEXIST ){
+      msg_error( "Failed to create fifo '%s' - %s", path, strerror(errno) );
+      return;
+   }
+   /* opened for writing too, the fifo never reads end of file */
+   ctl->fd = open( path, O_RDWR | O_NONBLOCK );
+   if ( ctl->fd < 0 ){
+      msg_error( "Failed to open fifo '%s' - %s", path, strerror(errno) );
+      return;
+   }
+   ctl->channel = channel_new( (AppClass *) ctl, ctl->fd, control_read_cb, NULL );
+   loop_channel_add( loop, ctl->channel );
+   msg_dbg( "reading commands from '%s'", path );
+}
+
+/** \brief Destructor for the VfddControl object.
+ *  the channel belongs to the loop */
+
+void control_destroy(void *ctl)
+{
+   VfddControl *this = (VfddControl *) ctl;
+
+   if (ctl == NULL) {
+      return;
+   }
+   if ( this->fd >= 0 ){
+      close( this->fd );
+   }
+   app_free(this->path);
+
+   app_class_destroy( ctl );
+}
+
+void control_set_stats_func( VfddControl *ctl, App_Run_FP func, void *user_data )
+{
+   ctl->stats_func = func;
+   ctl->stats_app = user_data;
+}
+
+void control_set_alarms( VfddControl *ctl, VfddAlarms *alarms )
+{
+   ctl->alarms = alarms;
+}
+
+/*
+ * the fifo is readable : run the complete lines
+ */
+int control_read_cb( Channel *cha, AppClass *user_data )
+{
+   VfddControl *ctl = (VfddControl *) cha->cnx;
+   char buf[CONTROL_LINE_SIZ];
+   ssize_t n;
+   int i;
+
+   n = read( ctl->fd, buf, sizeof(buf) );
+   if ( n <= 0 ){
+      return 0;
+   }
+   for ( i = 0 ; i < n ; i++ ){
+      if ( buf[i] == '\n' ){
+	 ctl->line[ctl->len] = 0;
+	 if ( ! ctl->skip ){
+	    control_exec( ctl, ctl->line );
+	 }
+	 ctl->len = 0;
+	 ctl->skip = 0;
+      } else if ( ctl->len < CONTROL_LINE_SIZ - 1 ){
+	 ctl->line[ctl->len++] = buf[i];
+      } else if ( ! ctl->skip ){
+	 msg_error( "'%s' : command longer than %d dropped", ctl->path,
+		    CONTROL_LINE_SIZ - 1 );
+	 ctl->skip = 1;
+      }
+   }
+   return 0;
+}
+
+/*
+ * run one command line
+ */
+void control_exec( VfddControl *ctl, char *line )
+{
+   const ControlCmd *cmd;
+   char *args;
+
+   line += strspn( line, " \t" );
+   if ( ! *line ){
+      return;
+   }
+   args = line + strcspn( line, " \t" );
+   if ( *args ){
+      *args++ = 0;
+      args += strspn( args, " \t" );
+   }
+   for ( cmd = control_cmds ; cmd->name ; cmd++ ){
+      if ( strcmp( cmd->name, line ) == 0 ){
+	 msg_dbg( "command %s '%s'", line, args );
+	 if ( cmd->func( ctl, args ) < 0 ){
+	    msg_error( "usage : %s", cmd->usage );
+	 }
+	 return;
+      }
+   }
+   msg_error( "'%s' : unknown command '%s'", ctl->path, line );
+}
+
+/*
+ * notify <priority> <ttl secs> <text>
+ */
+int control_cmd_notify( VfddControl *ctl, char *args )
+{
+   char *end;
+   long priority;
+   double ttl;
+
+   priority = strtol( args, &end, 10 );
+   if ( end == args ){
+      return -1;
+   }
+   args = end;
+   ttl = strtod( args, &end );
+   /* not ( ttl > 0 ) : nan too */
+   if ( end == args || ! ( ttl > 0 ) ){
+      return -1;
+   }
+   if ( ttl > NOTIFY_TTL_MAX ){
+      ttl = NOTIFY_TTL_MAX;
+   }
+   args = end + strspn( end, " \t" );
+   if ( ! *args ){
+      return -1;
+   }
+   notify_push( ctl->notify, priority, ttl * 1000, args, 0 );
+   return 0;
+}
+
+int control_cmd_clear( VfddControl *ctl, char *args )
+{
+   notify_clear( ctl->notify );
+   return 0;
+}
+
+int control_cmd_stats( VfddControl *ctl, char *args )
+{
+   if ( ctl->stats_func ){
+      ctl->stats_func( ctl->stats_app, ctl );
+   }
+   return 0;
+}
+
+/*
+ * alarm <HH:MM> [days] [ring secs]
+ */
+int control_cmd_alarm( VfddControl *ctl, char *args )
+{
+   char hhmm[16], days[32];
+   int duration = 0;
+
+   strcpy( days, "*" );
+   if ( ! ctl->alarms ||
+	sscanf( args, "%15s %31s %d", hhmm, days, &duration ) < 1 ){
+      return -1;
+   }
+   return alarm_add( ctl->alarms, hhmm, days, duration, 0 ) < 0 ? -1 : 0;
+}
+
+int control_cmd_unalarm( VfddControl *ctl, char *args )
+{
+   char *end;
+   long idx = strtol( args, &end, 10 );
+
+   if ( ! ctl->alarms || end == args ){
+      return -1;
+   }
+   return alarm_del( ctl->alarms, idx );
+}
+
+int control_cmd_alarms( VfddControl *ctl, char *args )
+{
+   if ( ctl->alarms ){
+      alarm_list( ctl->alarms );
+   }
+   return 0;
+}
+
+int control_cmd_stop( VfddControl *ctl, char *args )
+{
+   if ( ctl->alarms ){
+      alarm_stop( ctl->alarms );
+   }
+   return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+/*
+ * control.h - commands read from a fifo, one per line
+ *
+ * include LICENSE
+ */
+
+#include <loop.h>
+#include <channel.h>
+#include <notify.h>
+#include <alarm.h>
+
+#define CONTROL_LINE_SIZ 256     /* max length of a command line */
+
+typedef struct _VfddControl VfddControl;
+
+struct _VfddControl {
+   AppClass parent;
+   Loop *loop;                  /* the loop polling fd */
+   Channel *channel;            /* fd in the loop */
+   VfddNotify *notify;          /* queue of the notify command */
+   VfddAlarms *alarms;          /* table of the alarm commands */
+   char *path;                  /* fifo name */
+   int fd;                      /* fifo, -1 if it could not be opened */
+   char line[CONTROL_LINE_SIZ]; /* command line read so far */
+   int len;                     /* length of line */
+   int skip;                    /* 1 while a too long line is dropped */
+   App_Run_FP stats_func;       /* logs the daemon stats */
+   void *stats_app;
+};
+
+typedef int (*ControlCmdFunc)( VfddControl *ctl, char *args );
+
+typedef struct _ControlCmd ControlCmd;
+
+struct _ControlCmd {
+   const char *name;
+   ControlCmdFunc func;         /* returns -1 if args are wrong */
+   const char *usage;
+};
+
+/*
+ * prototypes
+ */
+VfddControl *control_new( Loop *loop, const char *path, VfddNotify *notify );
+void control_construct( VfddControl *ctl, Loop *loop, const char *path,
+			VfddNotify *notify );
+void control_destroy(void *ctl);
+
+int control_read_cb( Channel *cha, AppClass *user_data );
+void control_exec( VfddControl *ctl, char *line );
+void control_set_stats_func( VfddControl *ctl, App_Run_FP func, void *user_data );
+void control_set_alarms( VfddControl *ctl, VfddAlarms *alarms );
+
+#endif /* CONTROL_H */
@@ -0,0 +1,200 @@
+/*
+ * diskstats.c - disk activity of the devices shown.
+ *
+ *   /proc/diskstats is read once per poll for all the devices, and
+ *   scanned in place : a line of a device not watched is skipped
+ *   without being copied or fully converted. The rate of a device is
+ *   the bytes read and written between the last two reads.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <diskstats.h>
+#include <strmem.h>
+
+/* /proc/diskstats counts 512 bytes sectors whatever the device */
+#define DISKSTATS_SECTOR 512
+
+/*
+ * local prototypes
+ */
+void diskstats_scan( VfddDiskStats *ds, long ms );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddDiskStats object.
+ */
+
+VfddDiskStats *diskstats_new( Vfdd *vf )
+{
+   VfddDiskStats *ds;
+
+   ds =  app_new0(VfddDiskStats, 1);
+   diskstats_construct( ds, vf );
+   app_class_overload_destroy( (AppClass *) ds, diskstats_destroy );
+   return ds;
+}
+
+/** \brief Constructor for the VfddDiskStats object. */
+
+void diskstats_construct( VfddDiskStats *ds, Vfdd *vf )
+{
+   app_class_construct( (AppClass *) ds );
+
+   ds->src = source_get( vf, DISKSTATS_FILE );
+   source_set_size( ds->src, DISKSTATS_BUF_SIZ );
+   /* the counters always change, a steady poll gives steady rates */
+   ds->src->min_ms = DISKSTATS_POLL_MS;
+   ds->src->max_ms = DISKSTATS_POLL_MS;
+}
+
+/** \brief Destructor for the VfddDiskStats object.
+ *  the source belongs to the daemon */
+
+void diskstats_destroy(void *ds)
+{
+   VfddDiskStats *this = (VfddDiskStats *) ds;
+
+   if (ds == NULL) {
+      return;
+   }
+   msg_dbg( "diskstats %d devices %lu scans", this->dev_num, this->scans );
+
+   app_class_destroy( ds );
+}
+
+/*
+ * watch the device name, return its index or -1
+ */
+int diskstats_add( VfddDiskStats *ds, const char *name )
+{
+   int i;
+
+   for ( i = 0 ; i < ds->dev_num ; i++ ){
+      if ( strcmp( ds->devs[i].name, name ) == 0 ){
+	 return i;
+      }
+   }
+   if ( ds->dev_num >= DISKSTATS_MAX || strlen(name) >= DISKSTATS_NAME_SIZ ){
+      msg_error( "diskstats : cannot watch device '%s'", name );
+      return -1;
+   }
+   strcpy( ds->devs[ds->dev_num].name, name );
+   return ds->dev_num++;
+}
+
+/*
+ * one pass over the lines :
+ *   major minor name reads merged sectors ms writes merged sectors ...
+ * ms : milisecs since the previous read, 0 for the first one
+ */
+void diskstats_scan( VfddDiskStats *ds, long ms )
+{
+   char *p = ds->src->buf;
+   int was[DISKSTATS_MAX];
+   int i, j;
+
+   for ( i = 0 ; i < ds->dev_num ; i++ ){
+      was[i] = ds->devs[i].seen;
+      ds->devs[i].seen = 0;
+   }
+   while ( *p ){
+      char *eol = strchr( p, '\n' );
+      char *name, *end;
+      size_t len;
+
+      if ( ! eol ){
+	 eol = p + strlen(p);
+      }
+      /* skip major and minor, find the name */
+      strtoul( p, &end, 10 );
+      strtoul( end, &end, 10 );
+      name = end + strspn( end, " " );
+      len = strcspn( name, " \n" );
+
+      for ( i = 0 ; i < ds->dev_num ; i++ ){
+	 DiskDev *dev = &ds->devs[i];
+	 uint64_t f[7];
+
+	 if ( dev->seen || strncmp( dev->name, name, len ) != 0 || dev->name[len] ){
+	    continue;
+	 }
+	 end = name + len;
+	 for ( j = 0 ; j < 7 ; j++ ){
+	    f[j] = strtoull( end, &end, 10 );
+	 }
+	 /* sectors read and sectors written */
+	 uint64_t sectors = f[2] + f[6];
+	 /* a device back or a counter going back has no rate yet */
+	 if ( ms > 0 && was[i] && sectors >= dev->sectors ){
+	    dev->rate = ( sectors - dev->sectors ) * DISKSTATS_SECTOR * 1000 / ms;
+	 } else {
+	    dev->rate = 0;
+	 }
+	 dev->sectors = sectors;
+	 dev->seen = 1;
+	 break;
+      }
+      p = *eol ? eol + 1 : eol;
+   }
+   for ( i = 0 ; i < ds->dev_num ; i++ ){
+      if ( ! ds->devs[i].seen ){
+	 ds->devs[i].rate = 0;
+      }
+   }
+   ds->scans++;
+}
+
+/*
+ * read the counters if their poll is due at now, once for all the
+ * dotleds of all the panels, and scan a new read
+ */
+void diskstats_update( VfddDiskStats *ds, const struct timeval *now )
+{
+   struct timeval took;
+   long ms = 0;
+
+   source_poll( ds->src, now );
+   if ( timercmp( &ds->src->read_at, &ds->parsed, == ) ){
+      return;
+   }
+   if ( ds->scans ){
+      timersub( &ds->src->read_at, &ds->parsed, &took );
+      ms = took.tv_sec * 1000L + took.tv_usec / 1000;
+   }
+   /* a file not read is empty : no device seen */
+   ds->parsed = ds->src->read_at;
+   diskstats_scan( ds, ms );
+}
+
+/*
+ * bytes per sec of device idx
+ */
+unsigned long diskstats_rate( VfddDiskStats *ds, int idx )
+{
+   if ( idx < 0 || idx >= ds->dev_num ){
+      return 0;
+   }
+   return ds->devs[idx].rate;
+}
+
+/*
+ * boundaries in a blink of a disk at rate, 0 for no blink :
+ * the busier the disk, the faster the dot blinks
+ */
+int diskstats_blink_period( unsigned long rate )
+{
+   if ( rate == 0 ){
+      return 0;
+   }
+   if ( rate < 64 * 1024 ){
+      return 8;
+   }
+   if ( rate < 1024 * 1024 ){
+      return 4;
+   }
+   return 2;
+}
@@ -0,0 +1,55 @@
+#ifndef DISKSTATS_H
+#define DISKSTATS_H
+
+/*
+ * diskstats.h - disk activity of the devices shown, from one read
+ *               of /proc/diskstats for all of them
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <vfdd.h>
+#include <source.h>
+
+#define DISKSTATS_FILE     "/proc/diskstats"
+#define DISKSTATS_BUF_SIZ  16384    /* room for the lines of many devices */
+#define DISKSTATS_POLL_MS  1000     /* the counters are read every second */
+#define DISKSTATS_MAX      8        /* max devices watched */
+#define DISKSTATS_NAME_SIZ 32
+
+typedef struct _DiskDev DiskDev;
+
+struct _DiskDev {
+   char name[DISKSTATS_NAME_SIZ];  /* kernel name, ex "sda" */
+   uint64_t sectors;            /* sectors read and written */
+   unsigned long rate;          /* bytes per sec between the last two reads */
+   int seen;                    /* 1 if found by the last read */
+};
+
+typedef struct _VfddDiskStats VfddDiskStats;
+
+struct _VfddDiskStats {
+   AppClass parent;
+   VfddSource *src;             /* /proc/diskstats, one of the daemon sources */
+   struct timeval parsed;       /* read time of the data parsed last */
+   DiskDev devs[DISKSTATS_MAX];
+   int dev_num;
+   unsigned long scans;         /* reads parsed */
+};
+
+/*
+ * prototypes
+ */
+VfddDiskStats *diskstats_new( Vfdd *vf );
+void diskstats_construct( VfddDiskStats *ds, Vfdd *vf );
+void diskstats_destroy(void *ds);
+
+int diskstats_add( VfddDiskStats *ds, const char *name );
+void diskstats_update( VfddDiskStats *ds, const struct timeval *now );
+unsigned long diskstats_rate( VfddDiskStats *ds, int idx );
+int diskstats_blink_period( unsigned long rate );
+
+#endif /* DISKSTATS_H */
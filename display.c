@@ -7,54 +7,152 @@
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
 
 #include <display.h>
 #include <strmem.h>
 #include <jsonroot.h>
-#include <fileutil.h>
-#include <vfdd.h>
+#include <panel.h>
+#include <source.h>
+#include <sysstat.h>
+#include <sensors.h>
 
 /*
  * local prototypes
  */
 int display_get_temp(VfddDisplay *dis, Vfdd *vf );
+void display_add_input( VfddDisplay *dis, char *path );
+int display_iter_sysfiles( AppClass *data, void *user_data );
+void display_add_sensor( VfddDisplay *dis, char *key );
+int display_iter_sensors( AppClass *data, void *user_data );
+int display_get_sysstat(VfddDisplay *dis, Vfdd *vf );
 /* */
 
 /*
  *** \brief Allocates memory for a new VfddDisplay object.
  */
 
-VfddDisplay *display_new( AppClass *xnode, AppClass * xvf )
+VfddDisplay *display_new( AppClass *xnode, AppClass * xpanel )
 {
    VfddDisplay *dis;
 
    dis =  app_new0(VfddDisplay, 1);
-   display_construct( dis, xnode, xvf );
+   display_construct( dis, xnode, xpanel );
    app_class_overload_destroy( (AppClass *) dis, display_destroy );
    return dis;
 }
 
 /** \brief Constructor for the VfddDisplay object. */
 
-void display_construct( VfddDisplay *dis, AppClass *xnode, AppClass * xvf  )
+void display_construct( VfddDisplay *dis, AppClass *xnode, AppClass * xpanel  )
 {
    JsonNode *node = (JsonNode *) xnode;
    char *name;
    
    app_class_construct( (AppClass *) dis );
-   dis->xvf = xvf;
+   dis->xpanel = xpanel;
 
    dis->name = app_strdup(node->keyname);
    JsonNode *n = json_root_get_item_string(node, "sysfile",  &name );
    if ( n ){
       dis->sysfile = app_strdup(name);
+      display_add_input( dis, name );
+   }
+   /* "sysfiles" : [ "/sys/class/thermal/thermal_zone0/temp", ... ] */
+   n = json_node_find_node( node, "sysfiles" );
+   if ( n ){
+      dlist_iterator(n->child, display_iter_sysfiles, dis );
+   }
+   /* "sensor" : "cpu_thermal", "sensors" : [ "coretemp/Core 0", ... ]
+    * looked up in hwmon and thermal */
+   json_root_get_item_string(node, "sensor",  &name );
+   if ( name ){
+      display_add_sensor( dis, name );
+   }
+   n = json_node_find_node( node, "sensors" );
+   if ( n ){
+      dlist_iterator(n->child, display_iter_sensors, dis );
+   }
+   int i;
+   for ( i = 0 ; i < dis->src_num ; i++ ){
+      source_conf_bounds( dis->srcs[i], node );
+   }
+   /* "fresh_ms" : max age of the data when shown */
+   if ( ! json_root_get_item_int(node, "fresh_ms", &dis->fresh ) ){
+      dis->fresh = SOURCE_MIN_MS;
+   }
+   /* "aggregate" : "max" or "avg" of the inputs */
+   json_root_get_item_string(node, "aggregate",  &name );
+   dis->aggregate = app_strcmp( name, "avg" ) == 0 ? AGGREGATE_AVG : AGGREGATE_MAX;
+   if ( ! json_root_get_item_int(node, "smoothing", &dis->smoothing ) ||
+	dis->smoothing <= 0 || dis->smoothing > 100 ){
+      dis->smoothing = DISPLAY_SMOOTHING;
+   }
+   if ( ! json_root_get_item_int(node, "hysteresis", &dis->hysteresis ) ||
+	dis->hysteresis < 0 ){
+      dis->hysteresis = DISPLAY_HYSTERESIS;
    }
    n = json_root_get_item_string(node, "format",  &name );
    if ( n ){
       dis->format = app_strdup(name);
    }
    json_root_get_item_int(node, "order",  &dis->order );
+   dis->fmt = format_new( dis->format, dis->order >= DIS_TEMP ? FORMAT_INT : FORMAT_TIME );
 
+   /* the system functions share the /proc files of the daemon */
+   if ( dis->order >= DIS_CPU ){
+      Vfdd *vf = ((VfddPanel *) xpanel)->vf;
+      if ( ! vf->sysstat ){
+	 vf->sysstat = sysstat_new();
+      }
+   }
+   if ( dis->order == DIS_NET ){
+      /* "interface" : ex "wlan0" */
+      json_root_get_item_string(node, "interface",  &name );
+      dis->iface = sysstat_add_iface( ((VfddPanel *) xpanel)->vf->sysstat,
+				      name ? name : DISPLAY_IFACE );
+   }
+
+   /* the default slots : the date on secs 5 to 9, the temperature
+    * on 15 to 19 over the time */
+   switch (dis->order) {
+    case DIS_DATE:
+      dis->start = 5;
+      dis->duration = 5;
+      dis->priority = 1;
+      break;
+    case DIS_TEMP:
+      dis->start = 15;
+      dis->duration = 5;
+      dis->priority = 1;
+      dis->refresh = DISPLAY_TEMP_REFRESH;
+      break;
+    case DIS_CPU:
+    case DIS_MEM:
+    case DIS_NET:
+      /* after the temperature, 5 secs each */
+      dis->start = 25 + ( dis->order - DIS_CPU ) * 10;
+      dis->duration = 5;
+      dis->priority = 1;
+      dis->refresh = dis->order == DIS_MEM ? DISPLAY_TEMP_REFRESH : DISPLAY_LOAD_REFRESH;
+      break;
+    default:
+      dis->duration = INT_MAX;
+      break;
+   }
+   int val;
+   if ( json_root_get_item_int(node, "start", &val ) ){
+      dis->start = val;
+   }
+   if ( json_root_get_item_int(node, "duration", &val ) ){
+      dis->duration = val;
+   }
+   if ( json_root_get_item_int(node, "priority", &val ) ){
+      dis->priority = val;
+   }
+   if ( json_root_get_item_int(node, "refresh", &val ) ){
+      dis->refresh = val;
+   }
 }
 
 /** \brief Destructor for the VfddDisplay object. */
@@ -69,57 +167,196 @@ void display_destroy(void *dis)
    app_free(this->name);
    app_free(this->sysfile);
    app_free(this->format);
+   format_destroy(this->fmt);
 
    app_class_destroy( dis );
 }
 
+/*
+ * add a file to the inputs, shared with the other panels showing it
+ */
+void display_add_input( VfddDisplay *dis, char *path )
+{
+   VfddSource *src;
+
+   if ( dis->src_num >= DISPLAY_MAX_INPUTS ){
+      msg_error( "%s : more than %d sysfiles, '%s' ignored", dis->name,
+		 DISPLAY_MAX_INPUTS, path );
+      return;
+   }
+   src = source_get( ((VfddPanel *) dis->xpanel)->vf, path );
+   dis->srcs[dis->src_num++] = src;
+}
+
+int display_iter_sysfiles( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   VfddDisplay *dis = (VfddDisplay *) user_data;
+   char *path;
+
+   if ( node->jsonType == JSON_STRING ){
+      json_node_get_val_string( node, &path );
+      display_add_input( dis, path );
+   }
+   return 0;
+}
+
+void display_add_sensor( VfddDisplay *dis, char *key )
+{
+   Vfdd *vf = ((VfddPanel *) dis->xpanel)->vf;
+   const char *path;
+
+   if ( ! vf->sensors ){
+      vf->sensors = sensors_new( vf->state_dir );
+   }
+   path = sensors_resolve( vf->sensors, key );
+   if ( path ){
+      display_add_input( dis, (char *) path );
+   }
+}
+
+int display_iter_sensors( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   VfddDisplay *dis = (VfddDisplay *) user_data;
+   char *key;
+
+   if ( node->jsonType == JSON_STRING ){
+      json_node_get_val_string( node, &key );
+      display_add_sensor( dis, key );
+   }
+   return 0;
+}
+
+/*
+ * read the inputs in one pass, aggregate them in a moving average
+ * and return the degrees shown : the shown degree d changes when
+ * the average leaves [ d - hysteresis, d + 1 + hysteresis [
+ */
 int display_get_temp(VfddDisplay *dis, Vfdd *vf )
 {
-   char tmpbuf[256];
-   FILE *fd = NULL;
-   int val = 0;
-   
-   if ( dis->sysfile ){
-      if ( ! file_exists( dis->sysfile ) ){
-	 return 0;
+   long sum = 0, max = 0;
+   int i, num = 0, read = 0;
+
+   for ( i = 0 ; i < dis->src_num ; i++ ){
+      VfddSource *src = dis->srcs[i];
+
+      read |= source_fresh( src, &vf->tick, dis->fresh );
+      if ( src->len <= 0 ){
+	 continue;
+      }
+      /* the same bytes give the same value */
+      if ( src->hash != dis->hashes[i] ){
+	 dis->hashes[i] = src->hash;
+	 dis->raws[i] = strtol( src->buf, NULL, 10 );
       }
-      fd = fopen( dis->sysfile, "r");
-      if ( ! fd ) {
-	 msg_error("Failed to open file '%s' - %s", dis->sysfile, strerror(errno) );
-	 return 0;
+      if ( num == 0 || dis->raws[i] > max ){
+	 max = dis->raws[i];
       }
-      fread( tmpbuf, 1, sizeof(tmpbuf), fd);
-      fclose (fd);
-      val = strtoul( tmpbuf, NULL, 10 );
+      sum += dis->raws[i];
+      num++;
+   }
+   if ( ! read ){
+      return dis->val;
    }
-   return val;
+   /* no input left : 0 as before the average, which starts again */
+   if ( ! num ){
+      dis->ema_set = 0;
+      dis->val = 0;
+      return 0;
+   }
+   long raw = dis->aggregate == AGGREGATE_AVG ? sum / num : max;
+   if ( ! dis->ema_set ){
+      dis->ema = raw;
+      dis->ema_set = 1;
+      dis->val = raw / 1000;
+      return dis->val;
+   }
+   dis->ema += ( raw - dis->ema ) * dis->smoothing / 100;
+   if ( dis->ema < dis->val * 1000L - dis->hysteresis ||
+	dis->ema >= ( dis->val + 1 ) * 1000L + dis->hysteresis ){
+      dis->val = dis->ema / 1000;
+   }
+   return dis->val;
 }
 
-/* call back */
-int display_iter_update_cb(AppClass *xdis, void *user_data )
+/*
+ * the value of a system function, from a read of its /proc file
+ * shared by the functions shown in the same window
+ */
+int display_get_sysstat(VfddDisplay *dis, Vfdd *vf )
+{
+   VfddSysStat *ss = vf->sysstat;
+
+   switch (dis->order) {
+    case DIS_CPU:
+      sysstat_update( ss, SYSSTAT_CPU, &vf->tick, dis->fresh );
+      return sysstat_cpu_load( ss );
+    case DIS_MEM:
+      sysstat_update( ss, SYSSTAT_MEM, &vf->tick, dis->fresh );
+      return sysstat_mem_avail( ss );
+    case DIS_NET:
+      sysstat_update( ss, SYSSTAT_NET, &vf->tick, dis->fresh );
+      /* Mbps, rounded */
+      return ( sysstat_net_rate( ss, dis->iface ) + 500000 ) / 1000000;
+   }
+   return 0;
+}
+
+/*
+ * format the function value in the panel string
+ */
+void display_update( VfddDisplay *dis )
 {
    char buff[32];
    
-   VfddDisplay *dis = (VfddDisplay *) xdis;
-   Vfdd *vf = (Vfdd *) dis->xvf;
+   VfddPanel *pa = (VfddPanel *) dis->xpanel;
+   Vfdd *vf = pa->vf;
 
    switch (dis->order) {
     case DIS_DATE:
-      if ( vf->vftm->tm_sec < 5 || vf->vftm->tm_sec >= 10 ){
-	 return 0;
-      }
     case DIS_TIME:
-      strftime( buff, sizeof(buff), dis->format, vf->vftm);
+      format_time( dis->fmt, vf->vftm, buff, sizeof(buff) );
       break;
     case DIS_TEMP:
-      if ( vf->vftm->tm_sec < 15 || vf->vftm->tm_sec >= 20 ){
-	 return 0;
-      }
-      int val = display_get_temp( dis, vf );
-      snprintf( buff, sizeof(buff), dis->format, val / 1000 );
+      format_int( dis->fmt, display_get_temp( dis, vf ), buff, sizeof(buff) );
+      break;
+    case DIS_CPU:
+    case DIS_MEM:
+    case DIS_NET:
+      format_int( dis->fmt, display_get_sysstat( dis, vf ), buff, sizeof(buff) );
       break;
+    default:
+      return;
    }
-   app_dup_str(&vf->display_str, buff );
-  // vf->nocolon = dis->order;
-   return 0;
+   if ( app_strcmp( pa->display_str, buff ) != 0 ){
+      app_dup_str(&pa->display_str, buff );
+   }
+}
+
+/*
+ * return 1 if the slot holds phase, the secs in the rotation period
+ */
+int display_shown( VfddDisplay *dis, int phase, int period )
+{
+   if ( dis->duration >= period ){
+      return 1;
+   }
+   return ( ( phase - dis->start ) % period + period ) % period < dis->duration;
+}
+
+/*
+ * return the next time the value may change while shown at t,
+ * gmtoff : local time offset, a format changes on the local minute
+ */
+time_t display_next_refresh( VfddDisplay *dis, time_t t, long gmtoff )
+{
+   if ( dis->refresh > 0 ){
+      return t + dis->refresh;
+   }
+   if ( dis->order >= DIS_TEMP ){
+      return t + DISPLAY_TEMP_REFRESH;
+   }
+   int res = format_period( dis->fmt );
+   return t - ( ( t + gmtoff ) % res + res ) % res + res;
 }
@@ -7,32 +7,70 @@
  * include LICENSE
  */
 
+#include <time.h>
+
 #include <appclass.h>
+#include <format.h>
+#include <source.h>
+
+#define DISPLAY_TEMP_REFRESH 5  /* default secs between temperature reads */
+#define DISPLAY_LOAD_REFRESH 2  /* default secs between cpu or network reads */
+#define DISPLAY_IFACE "eth0"    /* default interface of the network function */
+#define DISPLAY_MAX_INPUTS 8    /* files of an aggregated temperature */
+#define DISPLAY_SMOOTHING 50    /* default percent of a new reading in the average */
+#define DISPLAY_HYSTERESIS 300  /* default millidegrees past a degree to show it */
 
 typedef struct _VfddDisplay VfddDisplay;
 
+enum _DisplayAggregate {
+   AGGREGATE_MAX,               /* the hottest input */
+   AGGREGATE_AVG,               /* the average of the inputs read */
+};
+
 enum _DisplayVfddInfo {
    DIS_TIME,
    DIS_DATE,
    DIS_TEMP,
+   DIS_CPU,                     /* cpu busy percent */
+   DIS_MEM,                     /* available memory, MiB */
+   DIS_NET,                     /* interface throughput, Mbps */
 };
 
 struct _VfddDisplay {
    AppClass parent;
-   AppClass *xvf;               /* caller object */
+   AppClass *xpanel;            /* the VfddPanel showing it */
    char *name;                  /* object name */
    char *sysfile;               /* /sys file that give the info */
+   VfddSource *srcs[DISPLAY_MAX_INPUTS];  /* sysfile or sysfiles data */
+   uint32_t hashes[DISPLAY_MAX_INPUTS];   /* hash of the data parsed in raws */
+   long raws[DISPLAY_MAX_INPUTS];         /* values parsed from srcs */
+   int src_num;
+   int fresh;                   /* max age in milisecs of the data shown */
+   int aggregate;               /* AGGREGATE_xxx of the inputs */
+   int smoothing;               /* percent of a new reading in ema */
+   int hysteresis;              /* millidegrees past a degree edge to show it */
+   long ema;                    /* moving average of the readings */
+   int ema_set;                 /* 1 once ema holds a reading */
+   int val;                     /* value shown, degrees for the temperature */
+   int iface;                   /* interface index of DIS_NET in the sysstat */
    char *format;                /* object display format */
+   VfddFormat *fmt;             /* format compiled */
    int order;                   /* 0 time, 1 date, 2 temp,... */
+   int start;                   /* slot start in the rotation period, secs */
+   int duration;                /* slot length, secs */
+   int priority;                /* the highest priority slot is shown */
+   int refresh;                 /* secs between updates while shown, 0 when the format changes */
 };
 
 /*
  * prototypes
  */
-VfddDisplay *display_new( AppClass *xnode, AppClass * xvf );
-void display_construct( VfddDisplay *dis, AppClass *xnode, AppClass * xvf );
+VfddDisplay *display_new( AppClass *xnode, AppClass * xpanel );
+void display_construct( VfddDisplay *dis, AppClass *xnode, AppClass * xpanel );
 void display_destroy(void *dis);
 
-int display_iter_update_cb(AppClass *xdis, void *user_data );
+void display_update( VfddDisplay *dis );
+int display_shown( VfddDisplay *dis, int phase, int period );
+time_t display_next_refresh( VfddDisplay *dis, time_t t, long gmtoff );
 
 #endif /* DISPLAY_H */
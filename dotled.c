@@ -9,8 +9,13 @@
 
 #include <dotled.h>
 #include <jsonroot.h>
-#include <fileutil.h>
-#include <stutil.h>
+#include <duprintf.h>
+#include <diskstats.h>
+
+/* directory of the LED class devices registered by the vfd driver */
+#define DOTLED_LEDS_DIR "/sys/class/leds"
+/* disk of the "disk" driver without device */
+#define DOTLED_DISK_DEVICE "sda"
 
 typedef struct _TestDotval TestDotval;
 
@@ -25,37 +30,42 @@ struct _TestDotval {
 int dotled_test_net(AppClass *data, void *user_data );
 int dotled_test_hdmi(AppClass *data, void *user_data );
 int dotled_test_colon(AppClass *data, void *user_data );
-int dotled_test_usb(AppClass *data, void *user_data );
+int dotled_test_disk(AppClass *data, void *user_data );
 int dotled_test_bluetooth(AppClass *data, void *user_data );
 int dotled_test_alarm(AppClass *data, void *user_data );
+int dotled_sysfs_store(const char *dir, const char *name, const char *val);
+int dotled_iter_trigger_attr( AppClass *data, void *user_data );
 /* */
 
 /*
  *** \brief Allocates memory for a new DotLed object.
  *  node : configuration node
- *  target: address of ram to modify
+ *  co : compositor of the panel
+ *  word : display word of the dot
  */
 
-DotLed *dotled_new( AppClass *xnode, uint16_t * target )
+DotLed *dotled_new( AppClass *xnode, VfddCompositor *co, int word )
 {
    DotLed *led;
 
    led =  app_new0(DotLed, 1);
-   dotled_construct( led, xnode, target );
+   dotled_construct( led, xnode, co, word );
    app_class_overload_destroy( (AppClass *) led, dotled_destroy );
    return led;
 }
 
 /** \brief Constructor for the DotLed object. */
 
-void dotled_construct( DotLed *led, AppClass *xnode,  uint16_t * target )
+void dotled_construct( DotLed *led, AppClass *xnode, VfddCompositor *co, int word )
 {
    char *name;
    app_class_construct( (AppClass *) led );
 
    JsonNode *node = (JsonNode *) xnode;
-   led->target = target;
+   led->co = co;
+   led->word = word;
    led->name = app_strdup(node->keyname);
+   led->disk = -1;
 
    JsonNode *n = json_root_get_item_string(node, "sysfile",  &name );
    if ( n ){
@@ -65,6 +75,9 @@ void dotled_construct( DotLed *led, AppClass *xnode,  uint16_t * target )
    if ( n ){
       dotled_set_test_func(led, name );
    }
+   if ( led->test_func == dotled_test_disk ){
+      dotled_set_device( led, xnode );
+   }
    n = json_root_get_item_int(node, "bit",  &led->bit );
    if ( ! n ){
       msg_error( "dotled bit not defined" );
@@ -82,6 +95,7 @@ void dotled_destroy(void *led)
    }
    app_free(this->name);
    app_free(this->sysfile);
+   app_free(this->device);
 
    app_class_destroy( led );
 }
@@ -99,29 +113,60 @@ int dotled_name_str_cmp(AppClass *d1, AppClass *d2 )
    return app_strcmp( led->name, name );
 }
 
+/*
+ * user_data : the daemon, a sysfile is read when its poll is due
+ * and tested when its data have changed
+ */
 int dotled_iter_update(AppClass *data, void *user_data )
 {
    DotLed *led = (DotLed *) data;
-   char tmpbuf[256];
-   FILE *fd = NULL;
+   Vfdd *vf = (Vfdd *) user_data;
+   int val = 0;
+   int blink;
    
-   if ( led->sysfile ){
-      if ( ! file_exists( led->sysfile ) ){
+   if ( led->src ){
+      source_poll( led->src, &vf->tick );
+      if ( led->src->len < 0 ){
+	 compositor_set_bit( led->co, LAYER_DOTLED, led->word, led->bit, 0 );
+	 led->hash = 0;
 	 return 0;
       }
-      fd = fopen( led->sysfile, "r");
-      if ( ! fd ) {
-	 msg_error("Failed to open file '%s' - %s", led->sysfile, strerror(errno) );
+      if ( led->src->hash == led->hash ){
 	 return 0;
       }
-      led->tmplen = fread( tmpbuf, 1, sizeof(tmpbuf), fd);
-      fclose (fd);
-      led->tmpbuf = tmpbuf;
+      led->hash = led->src->hash;
+      led->tmpbuf = led->src->buf;
+      led->tmplen = led->src->len;
    }
    if ( led->test_func ) {
-      int val = led->test_func(data, user_data);
-      if ( val ){
-	 *led->target |= (1 << led->bit);
+      val = led->test_func(data, user_data);
+   }
+   /* a ringing alarm dot is on the blink layer, the phase flips it */
+   blink = led->test_func == dotled_test_alarm && ! led->src &&
+      alarm_ringing( vf->alarms );
+   /* the layer keeps the dot, only a flip dirties its word */
+   compositor_set_bit( led->co, LAYER_DOTLED, led->word, led->bit, val && ! blink );
+   compositor_set_bit( led->co, LAYER_BLINK, led->word, led->bit, blink );
+   return 0;
+}
+
+/*
+ * user_data : the daemon, due at the earliest read of the
+ * sysfile or the diskstats, and on each boundary while blinking :
+ * the panel wakes on each one while the blink layer is used
+ */
+int dotled_iter_due(AppClass *data, void *user_data )
+{
+   DotLed *led = (DotLed *) data;
+   Vfdd *vf = (Vfdd *) user_data;
+
+   if ( led->src ){
+      vfdd_set_due( vf, &led->src->next );
+   }
+   if ( led->disk >= 0 ){
+      vfdd_set_due( vf, &vf->disks->src->next );
+      if ( led->blink ){
+	 vfdd_set_due( vf, &vf->tick );
       }
    }
    return 0;
@@ -152,29 +197,39 @@ int dotled_test_hdmi(AppClass *data, void *user_data )
    return 0;
 }
 
-int dotled_test_usb(AppClass *data, void *user_data )
+/*
+ * the dot blinks while the disk is busy, all the dots on the
+ * same boundaries : the blink is a number of boundaries
+ */
+int dotled_test_disk(AppClass *data, void *user_data )
 {
-   int ret = 0;
    DotLed *led = (DotLed *) data;
-   int i;
-   char *sn = led->tmpbuf;
-   char *tok;
+   Vfdd *vf = (Vfdd *) user_data;
 
-   for ( i = 0 ; i < 11 ; i++ ){
-      tok = stu_token_next(&sn, " ", " ");
+   if ( led->disk < 0 ){
+      return 0;
    }
-   int val = strtoul( tok, NULL, 10 );
-   if ( val > 0 ){
-      ret = 1;
+   diskstats_update( vf->disks, &vf->tick );
+   led->blink = diskstats_blink_period( diskstats_rate( vf->disks, led->disk ) );
+   if ( ! led->blink ){
+      return 0;
    }
-   return 0;
+   return ( vf->boundary % led->blink ) < (unsigned) led->blink / 2;
 }
 
+/*
+ * without sysfile : lit while an alarm is set, blinking while it rings
+ * through the blink layer
+ */
 int dotled_test_alarm(AppClass *data, void *user_data )
 {
    int ret = 0;
    DotLed *led = (DotLed *) data;
+   Vfdd *vf = (Vfdd *) user_data;
 
+   if ( ! led->src ){
+      return vf->alarms->num > 0 || alarm_ringing( vf->alarms );
+   }
    if ( *led->tmpbuf == '1' ){
       ret = 1;
    }
@@ -197,8 +252,9 @@ static TestDotval test_fun_tbl[] = {
    { "hdmi", 0            },
    { "colon", dotled_test_colon          },
    { "bluetooth", 0  },
-   { "usb", 0              },
-   { "alarm", 0          },
+   { "usb", dotled_test_disk           },
+   { "disk", dotled_test_disk          },
+   { "alarm", dotled_test_alarm          },
    { NULL, NULL                          },
 };
 
@@ -215,3 +271,105 @@ void dotled_set_test_func(DotLed *led, char *name)
    }
    msg_warning( "driver for  '%s' not found\n", name );
 }
+
+/*
+ * "device" : the disk of the dot, ex "sda", else taken from
+ * a "/sys/block/<device>/stat" sysfile. The diskstats are read
+ * instead of the sysfile.
+ */
+void dotled_set_device(DotLed *led, AppClass *xnode)
+{
+   JsonNode *node = (JsonNode *) xnode;
+   char *name;
+   char dev[DISKSTATS_NAME_SIZ];
+
+   json_root_get_item_string(node, "device",  &name );
+   if ( ! name && led->sysfile &&
+	sscanf( led->sysfile, "/sys/block/%31[^/]/stat", dev ) == 1 ){
+      name = dev;
+   }
+   led->device = app_strdup( name ? name : DOTLED_DISK_DEVICE );
+   app_free(led->sysfile);
+   led->sysfile = NULL;
+}
+
+/*
+ * write a value in a sysfs file dir/name
+ */
+int dotled_sysfs_store(const char *dir, const char *name, const char *val)
+{
+   char *path = app_strdup_printf( "%s/%s", dir, name );
+   int ret = 0;
+
+   FILE *fd = fopen( path, "w");
+   if ( ! fd ) {
+      msg_error("Failed to open file '%s' - %s", path, strerror(errno) );
+      ret = -1;
+   } else {
+      fputs( val, fd );
+      if ( fclose(fd) ){
+	 msg_error("Failed to write '%s' to '%s' - %s", val, path, strerror(errno) );
+	 ret = -1;
+      }
+   }
+   app_free(path);
+   return ret;
+}
+
+int dotled_iter_trigger_attr( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   char *dir = (char *) user_data;
+   char buf[32];
+   char *val;
+
+   if ( node->jsonType == JSON_STRING ){
+      json_node_get_val_string(node, &val );
+   } else {
+      int n;
+      json_node_get_val_int(node, &n );
+      snprintf( buf, sizeof(buf), "%d", n );
+      val = buf;
+   }
+   dotled_sysfs_store( dir, node->keyname, val );
+   return 0;
+}
+
+/*
+ * The vfd driver registers every dotled as a LED class device.
+ * If the configuration gives a "trigger", hand the dotled to the kernel:
+ *   "led" : LED class device name, ex "vfd::NET"
+ *   "trigger" : kernel trigger, ex "netdev", "disk-activity", "timer"
+ *   "trigger_attrs" : trigger attributes, ex { "device_name": "eth0", "link": 1 }
+ * Return 1 if the kernel drives the dotled and it must not be polled.
+ */
+int dotled_set_kernel_trigger( AppClass *xnode )
+{
+   JsonNode *node = (JsonNode *) xnode;
+   char *trigger;
+   char *name;
+
+   json_root_get_item_string(node, "trigger",  &trigger );
+   if ( ! trigger ){
+      return 0;
+   }
+   json_root_get_item_string(node, "led",  &name );
+   if ( ! name ){
+      msg_error( "dotled '%s' trigger without led name", node->keyname );
+      return 0;
+   }
+
+   char *dir = app_strdup_printf( "%s/%s", DOTLED_LEDS_DIR, name );
+   if ( dotled_sysfs_store( dir, "trigger", trigger ) < 0 ){
+      /* old driver : keep polling */
+      app_free(dir);
+      return 0;
+   }
+   JsonNode *attrs = json_node_find_node( node, "trigger_attrs" );
+   if ( attrs ){
+      dlist_iterator(attrs->child, dotled_iter_trigger_attr, dir );
+   }
+   msg_info( "dotled '%s' driven by kernel trigger '%s'", node->keyname, trigger );
+   app_free(dir);
+   return 1;
+}
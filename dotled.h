@@ -9,6 +9,8 @@
 #include <stdint.h>
 
 #include <appclass.h>
+#include <compositor.h>
+#include <source.h>
 
 typedef struct _DotLed DotLed;
 
@@ -21,20 +23,29 @@ struct _DotLed {
    char *sysfile;                /* /sys file that give the info */ 
    char *tmpbuf;                 /* pointer to a temp buffer */ 
    int tmplen;                   /* len of data in tmpbuf */
-   uint16_t * target;            /* ram memory address for dot */
-   int bit;                      /* bit number in target */
+   VfddSource *src;              /* sysfile data, NULL without sysfile */
+   char *device;                 /* disk of the "disk" driver, NULL otherwise */
+   int disk;                     /* index of device in the diskstats */
+   int blink;                    /* boundaries in a blink of the disk dot, 0 if steady */
+   uint32_t hash;                /* hash of the data tested last */
+   VfddCompositor *co;           /* compositor of the panel */
+   int word;                     /* display word of the dot in the dotled layer */
+   int bit;                      /* bit number in word */
 };
 
 /*
  * prototypes
  */
-DotLed *dotled_new( AppClass *node, uint16_t * target );
-void dotled_construct( DotLed *led, AppClass *node, uint16_t * target );
+DotLed *dotled_new( AppClass *node, VfddCompositor *co, int word );
+void dotled_construct( DotLed *led, AppClass *node, VfddCompositor *co, int word );
 void dotled_destroy(void *led);
 
 int dotled_name_str_cmp(AppClass *d1, AppClass *d2 );
 void dotled_set_cb_func(DotLed *led, App_Run_FP func, void *user_data );
 int dotled_iter_update(AppClass *data, void *user_data );
+int dotled_iter_due(AppClass *data, void *user_data );
 void dotled_set_test_func(DotLed *led, char *name);
+void dotled_set_device(DotLed *led, AppClass *xnode);
+int dotled_set_kernel_trigger( AppClass *xnode );
 
 #endif /* DOTLED_H */
@@ -0,0 +1,259 @@
+/*
+ * font.c - glyph atlases for 7-, 14-, 16-segment and 5x7 dot matrix displays.
+ *
+ *   A font holds the images of a range of code points packed in one
+ *   array, a glyph is found by its offset from the first code point.
+ *   The builtin fonts cover ' ' to the degree sign, a font file may
+ *   hold any range.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <font.h>
+#include <strmem.h>
+#include <duprintf.h>
+
+#include <vfd-glyphs.c.h>
+#include <vfd-fonts.c.h>
+
+/*
+ * local prototypes
+ */
+int font_geometry( int segments, int *words, int *bits );
+void font_set_glyph( VfddFont *font, uint32_t code, const uint16_t *image );
+uint16_t font_image14( uint16_t image16 );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddFont object.
+ *  segments : 7, 14, 16, or 35 for a 5x7 dot matrix
+ *  return the builtin font
+ */
+
+VfddFont *font_new( int segments )
+{
+   VfddFont *font;
+   uint16_t image[FONT_MAX_WORDS];
+   int words, bits;
+   int i, w;
+
+   if ( font_geometry( segments, &words, &bits ) < 0 ){
+      msg_error( "no %d segments font, using 7 segments", segments );
+      segments = 7;
+   }
+   font = font_new_empty( segments, ' ', FONT_DEGREE - ' ' + 1 );
+
+   switch ( segments ){
+   case 7:
+      font->name = app_strdup("7seg");
+      for ( i = 0 ; vfd_glyphs[i].code != 0 ; i++ ){
+	 image[0] = vfd_glyphs[i].image;
+	 font_set_glyph( font, (uint8_t) vfd_glyphs[i].code, image );
+      }
+      /* '*' is drawn as a degree sign */
+      font_set_glyph( font, FONT_DEGREE, font_glyph( font, '*' ) );
+      break;
+   case 14:
+   case 16:
+      font->name = app_strdup_printf("%dseg", segments);
+      for ( i = 0 ; vfd_glyphs16[i].code != 0 ; i++ ){
+	 image[0] = vfd_glyphs16[i].image;
+	 if ( segments == 14 ){
+	    image[0] = font_image14( image[0] );
+	 }
+	 font_set_glyph( font, vfd_glyphs16[i].code, image );
+      }
+      break;
+   case 35:
+      font->name = app_strdup("5x7");
+      for ( i = 0 ; i < FONT5X7_COUNT ; i++ ){
+	 for ( w = 0 ; w < 5 ; w++ ){
+	    image[w] = vfd_font5x7[i][w];
+	 }
+	 font_set_glyph( font, FONT5X7_FIRST + i, image );
+      }
+      for ( w = 0 ; w < 5 ; w++ ){
+	 image[w] = vfd_font5x7_degree[w];
+      }
+      font_set_glyph( font, FONT_DEGREE, image );
+      break;
+   }
+   return font;
+}
+
+/*
+ *** \brief Allocates memory for a new VfddFont object with blank glyphs
+ *  for the code points first to first + count - 1.
+ */
+
+VfddFont *font_new_empty( int segments, uint32_t first, uint32_t count )
+{
+   VfddFont *font;
+
+   font =  app_new0(VfddFont, 1);
+   font_construct( font, segments, first, count );
+   app_class_overload_destroy( (AppClass *) font, font_destroy );
+   return font;
+}
+
+/** \brief Constructor for the VfddFont object. */
+
+void font_construct( VfddFont *font, int segments, uint32_t first, uint32_t count )
+{
+   app_class_construct( (AppClass *) font );
+
+   font_geometry( segments, &font->words, &font->bits );
+   font->segments = segments;
+   font->first = first;
+   font->count = count;
+   font->atlas = app_new0( uint16_t, count * font->words );
+}
+
+/** \brief Destructor for the VfddFont object. */
+
+void font_destroy(void *font)
+{
+   VfddFont *this = (VfddFont *) font;
+
+   if (font == NULL) {
+      return;
+   }
+   app_free(this->name);
+   app_free(this->atlas);
+
+   app_class_destroy( font );
+}
+
+/*
+ * words per glyph and segments per word of a font,
+ * return -1 if there is no such font, a 7 segments one is described
+ */
+int font_geometry( int segments, int *words, int *bits )
+{
+   *words = 1;
+   *bits = 7;
+   switch ( segments ){
+   case 7:
+   case 14:
+   case 16:
+      *bits = segments;
+      return 0;
+   case 35:
+      *words = 5;
+      return 0;
+   }
+   return -1;
+}
+
+void font_set_glyph( VfddFont *font, uint32_t code, const uint16_t *image )
+{
+   uint32_t k = code - font->first;
+
+   if ( k < font->count ){
+      memcpy( &font->atlas[k * font->words], image, font->words * 2 );
+   }
+}
+
+/*
+ * return the word images of code, blank if the font has no such glyph
+ */
+const uint16_t *font_glyph( const VfddFont *font, uint32_t code )
+{
+   uint32_t k = code - font->first;
+
+   return k < font->count ? &font->atlas[k * font->words] : font->blank;
+}
+
+/*
+ * 14-segment image of a 16-segment one : a = a1|a2, d = d1|d2,
+ * then e f g1 g2 h i j k l m like the 16-segment images.
+ */
+uint16_t font_image14( uint16_t image16 )
+{
+   uint16_t image = 0;
+
+   if ( image16 & 0x0003 ){
+      image |= 0x0001;
+   }
+   image |= ( image16 >> 1 ) & 0x0006;   /* b c */
+   if ( image16 & 0x0030 ){
+      image |= 0x0008;
+   }
+   image |= ( image16 >> 2 ) & 0x3FF0;   /* e to m */
+   return image;
+}
+
+/*
+ * return the font of a font file, NULL on error
+ */
+VfddFont *font_load( const char *path )
+{
+   uint8_t hdr[FONT_HEADER_SIZ];
+   VfddFont *font = NULL;
+   int words, bits;
+   uint32_t i;
+
+   FILE *fd = fopen( path, "r");
+   if ( ! fd ){
+      msg_error("Failed to open font '%s' - %s", path, strerror(errno) );
+      return NULL;
+   }
+   if ( fread( hdr, sizeof(hdr), 1, fd ) != 1 ||
+	memcmp( hdr, FONT_MAGIC, 4 ) != 0 ){
+      msg_error("'%s' is not a font file", path );
+      goto ret_error;
+   }
+   uint32_t count = hdr[6] | hdr[7] << 8;
+   uint32_t first = hdr[8] | hdr[9] << 8 | hdr[10] << 16 | (uint32_t) hdr[11] << 24;
+   if ( font_geometry( hdr[4], &words, &bits ) < 0 || hdr[5] != words ){
+      msg_error("'%s' : no %d segments font of %d words per glyph",
+		path, hdr[4], hdr[5] );
+      goto ret_error;
+   }
+
+   font = font_new_empty( hdr[4], first, count );
+   font->name = app_strdup(path);
+   for ( i = 0 ; i < count * words ; i++ ){
+      uint8_t le[2];
+
+      if ( fread( le, sizeof(le), 1, fd ) != 1 ){
+	 msg_error("'%s' is truncated, %u glyphs expected", path, count );
+	 font_destroy( font );
+	 font = NULL;
+	 goto ret_error;
+      }
+      font->atlas[i] = le[0] | le[1] << 8;
+   }
+   msg_dbg( "font '%s' : %d segments, %u glyphs from U+%04X",
+	    path, font->segments, count, first );
+
+ret_error:
+   fclose(fd);
+   return font;
+}
+
+/*
+ * Return the font images on the display bits : segment j of a
+ * glyph image lights bit segno[j] of the display word.
+ */
+VfddFont *font_remap( const VfddFont *font, const uint8_t *segno )
+{
+   VfddFont *dst = font_new_empty( font->segments, font->first, font->count );
+   uint32_t i;
+   int j;
+
+   dst->name = app_strdup(font->name);
+   for ( i = 0 ; i < font->count * font->words ; i++ ){
+      uint16_t src = font->atlas[i];
+
+      for ( j = 0 ; j < font->bits ; j++ ){
+	 if ( src & (1 << j) ){
+	    dst->atlas[i] |= 1U << segno[j];
+	 }
+      }
+   }
+   return dst;
+}
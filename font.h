@@ -0,0 +1,59 @@
+#ifndef FONT_H
+#define FONT_H
+
+/*
+ * font.h - glyph atlases for 7-, 14-, 16-segment and 5x7 dot matrix displays
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+
+#include <appclass.h>
+
+#define FONT_MAX_WORDS   5       /* display words of a glyph : 5 dot matrix columns */
+#define FONT_MAX_BITS    16      /* segments of a display word */
+#define FONT_DEGREE      0xB0    /* degree sign, the last builtin glyph */
+
+/*
+ * Font file, little endian :
+ *   char     magic[4]   "VFDF"
+ *   uint8_t  segments   7, 14, 16, or 35 for a 5x7 dot matrix
+ *   uint8_t  words      display words per glyph, 1 or 5 for a dot matrix
+ *   uint16_t count      number of glyphs
+ *   uint32_t first      code point of the first glyph
+ *   uint16_t image[count * words]
+ * Images use the segment order of the builtin fonts : bit n is entry n of
+ * the "segment_no" configuration table, a dot matrix glyph is 5 columns
+ * from left to right with row n from the top in bit n.
+ */
+#define FONT_MAGIC       "VFDF"
+#define FONT_HEADER_SIZ  12
+
+typedef struct _VfddFont VfddFont;
+
+struct _VfddFont {
+   AppClass parent;
+   char *name;             /* builtin font name or font file path */
+   int segments;           /* 7, 14 or 16 segments, 35 for a 5x7 dot matrix */
+   int words;              /* display words per glyph */
+   int bits;               /* segments of a display word */
+   uint32_t first;         /* code point of the first glyph */
+   uint32_t count;         /* number of glyphs */
+   uint16_t *atlas;        /* count * words glyph images, packed */
+   uint16_t blank[FONT_MAX_WORDS];  /* image of a code point without glyph */
+};
+
+/*
+ * prototypes
+ */
+VfddFont *font_new( int segments );
+VfddFont *font_new_empty( int segments, uint32_t first, uint32_t count );
+void font_construct( VfddFont *font, int segments, uint32_t first, uint32_t count );
+void font_destroy(void *font);
+
+VfddFont *font_load( const char *path );
+VfddFont *font_remap( const VfddFont *font, const uint8_t *segno );
+const uint16_t *font_glyph( const VfddFont *font, uint32_t code );
+
+#endif /* FONT_H */
@@ -0,0 +1,326 @@
+/*
+ * format.c - display function formats compiled into a list of
+ *            literals and numeric fields.
+ *
+ *   The configured strftime or printf format is parsed once. Showing
+ *   it then writes literals and table driven digits, a conversion
+ *   that is not compiled leaves the whole format to libc.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <format.h>
+#include <strmem.h>
+
+typedef struct _FormatConv FormatConv;
+
+struct _FormatConv {
+   char conv;                   /* strftime conversion character */
+   int field;
+   int width;
+   char pad;
+};
+
+/* strftime conversions of numeric fields */
+static const FormatConv format_tm_convs[] = {
+   { 'H', FIELD_HOUR, 2, '0' },
+   { 'k', FIELD_HOUR, 2, ' ' },
+   { 'I', FIELD_HOUR12, 2, '0' },
+   { 'l', FIELD_HOUR12, 2, ' ' },
+   { 'p', FIELD_AMPM, 0, 0 },
+   { 'M', FIELD_MIN, 2, '0' },
+   { 'S', FIELD_SEC, 2, '0' },
+   { 'd', FIELD_MDAY, 2, '0' },
+   { 'e', FIELD_MDAY, 2, ' ' },
+   { 'm', FIELD_MON, 2, '0' },
+   { 'y', FIELD_YEAR2, 2, '0' },
+   { 'Y', FIELD_YEAR, 1, '0' },
+   { 'j', FIELD_YDAY, 3, '0' },
+   { 0, 0, 0, 0 },
+};
+
+/* two digits of 0 to 99 */
+static const char format_digits[] =
+   "0001020304050607080910111213141516171819"
+   "2021222324252627282930313233343536373839"
+   "4041424344454647484950515253545556575859"
+   "6061626364656667686970717273747576777879"
+   "8081828384858687888990919293949596979899";
+
+/*
+ * local prototypes
+ */
+void format_compile( VfddFormat *fmt );
+int format_compile_tm( FormatOp *op, const char **p );
+int format_compile_int( FormatOp *op, const char **p );
+int format_run( VfddFormat *fmt, const struct tm *tm, int val, char *buf, int size );
+char *format_put_num( char *p, char *end, int val, int width, char pad );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddFormat object.
+ *  src : the configured format
+ *  kind : FORMAT_TIME or FORMAT_INT
+ */
+
+VfddFormat *format_new( const char *src, int kind )
+{
+   VfddFormat *fmt;
+
+   fmt =  app_new0(VfddFormat, 1);
+   format_construct( fmt, src, kind );
+   app_class_overload_destroy( (AppClass *) fmt, format_destroy );
+   return fmt;
+}
+
+/** \brief Constructor for the VfddFormat object. */
+
+void format_construct( VfddFormat *fmt, const char *src, int kind )
+{
+   app_class_construct( (AppClass *) fmt );
+
+   fmt->src = app_strdup( src ? src : "" );
+   fmt->kind = kind;
+   format_compile( fmt );
+   if ( fmt->fallback ){
+      msg_dbg( "format '%s' left to libc", fmt->src );
+   }
+}
+
+/** \brief Destructor for the VfddFormat object. */
+
+void format_destroy(void *fmt)
+{
+   VfddFormat *this = (VfddFormat *) fmt;
+
+   if (fmt == NULL) {
+      return;
+   }
+   app_free(this->src);
+
+   app_class_destroy( fmt );
+}
+
+/*
+ * split src in ops, the literals point in src
+ */
+void format_compile( VfddFormat *fmt )
+{
+   const char *p = fmt->src;
+
+   while ( *p ){
+      if ( fmt->op_num >= FORMAT_MAX_OPS ){
+	 fmt->fallback = 1;
+	 return;
+      }
+      FormatOp *op = &fmt->ops[fmt->op_num];
+      int ret;
+
+      if ( *p != '%' || p[1] == '%' ){
+	 /* "%%" is a literal '%' */
+	 if ( *p == '%' ){
+	    p++;
+	 }
+	 const char *q = strchr( p + 1, '%' );
+	 op->field = FIELD_LIT;
+	 op->lit = p;
+	 op->len = q ? q - p : (int) strlen( p );
+	 p += op->len;
+	 fmt->op_num++;
+	 continue;
+      }
+      p++;
+      if ( fmt->kind == FORMAT_TIME ){
+	 ret = format_compile_tm( op, &p );
+      } else {
+	 ret = format_compile_int( op, &p );
+      }
+      if ( ret < 0 ){
+	 fmt->fallback = 1;
+	 return;
+      }
+      fmt->op_num++;
+   }
+}
+
+/*
+ * *p is after '%', return -1 if the conversion is not compiled
+ */
+int format_compile_tm( FormatOp *op, const char **p )
+{
+   const FormatConv *cv;
+
+   for ( cv = format_tm_convs ; cv->conv ; cv++ ){
+      if ( cv->conv == **p ){
+	 op->field = cv->field;
+	 op->width = cv->width;
+	 op->pad = cv->pad;
+	 (*p)++;
+	 return 0;
+      }
+   }
+   return -1;
+}
+
+/*
+ * %d, %<width>d or %0<width>d
+ */
+int format_compile_int( FormatOp *op, const char **p )
+{
+   const char *s = *p;
+
+   op->field = FIELD_INT;
+   op->pad = ' ';
+   if ( *s == '0' ){
+      op->pad = '0';
+      s++;
+   }
+   for ( op->width = 0 ; *s >= '0' && *s <= '9' ; s++ ){
+      op->width = op->width * 10 + *s - '0';
+   }
+   if ( *s != 'd' && *s != 'i' ){
+      return -1;
+   }
+   *p = s + 1;
+   return 0;
+}
+
+/*
+ * write val in at least width characters, return the end of the number
+ */
+char *format_put_num( char *p, char *end, int val, int width, char pad )
+{
+   char digits[12];
+   unsigned int u = val < 0 ? - (unsigned int) val : (unsigned int) val;
+   int n = 0;
+
+   /* digits in reverse order, two at a time */
+   while ( u >= 100 ){
+      unsigned int r = u % 100;
+      u /= 100;
+      digits[n++] = format_digits[2 * r + 1];
+      digits[n++] = format_digits[2 * r];
+   }
+   if ( u >= 10 ){
+      digits[n++] = format_digits[2 * u + 1];
+      digits[n++] = format_digits[2 * u];
+   } else {
+      digits[n++] = '0' + u;
+   }
+
+   int fill = width - n - ( val < 0 );
+   if ( val < 0 && pad == '0' && p < end ){
+      *p++ = '-';
+   }
+   for ( ; fill > 0 && p < end ; fill-- ){
+      *p++ = pad;
+   }
+   if ( val < 0 && pad != '0' && p < end ){
+      *p++ = '-';
+   }
+   while ( n > 0 && p < end ){
+      *p++ = digits[--n];
+   }
+   return p;
+}
+
+int format_run( VfddFormat *fmt, const struct tm *tm, int val, char *buf, int size )
+{
+   char *p = buf;
+   char *end = buf + size - 1;
+   int i;
+
+   for ( i = 0 ; i < fmt->op_num ; i++ ){
+      FormatOp *op = &fmt->ops[i];
+      int n = 0;
+
+      switch ( op->field ){
+      case FIELD_LIT:
+	 n = op->len < end - p ? op->len : end - p;
+	 memcpy( p, op->lit, n );
+	 p += n;
+	 continue;
+      case FIELD_AMPM:
+	 n = end - p < 2 ? end - p : 2;
+	 memcpy( p, tm->tm_hour < 12 ? "AM" : "PM", n );
+	 p += n;
+	 continue;
+      case FIELD_HOUR:
+	 n = tm->tm_hour;
+	 break;
+      case FIELD_HOUR12:
+	 n = tm->tm_hour % 12 ? tm->tm_hour % 12 : 12;
+	 break;
+      case FIELD_MIN:
+	 n = tm->tm_min;
+	 break;
+      case FIELD_SEC:
+	 n = tm->tm_sec;
+	 break;
+      case FIELD_MDAY:
+	 n = tm->tm_mday;
+	 break;
+      case FIELD_MON:
+	 n = tm->tm_mon + 1;
+	 break;
+      case FIELD_YEAR2:
+	 n = tm->tm_year % 100;
+	 break;
+      case FIELD_YEAR:
+	 n = tm->tm_year + 1900;
+	 break;
+      case FIELD_YDAY:
+	 n = tm->tm_yday + 1;
+	 break;
+      case FIELD_INT:
+	 n = val;
+	 break;
+      }
+      p = format_put_num( p, end, n, op->width, op->pad );
+   }
+   *p = 0;
+   return p - buf;
+}
+
+/*
+ * format tm in buf of size bytes, return the string length
+ */
+int format_time( VfddFormat *fmt, const struct tm *tm, char *buf, int size )
+{
+   if ( fmt->fallback ){
+      return strftime( buf, size, fmt->src, tm );
+   }
+   return format_run( fmt, tm, 0, buf, size );
+}
+
+/*
+ * format val in buf of size bytes, return the string length
+ */
+int format_int( VfddFormat *fmt, int val, char *buf, int size )
+{
+   if ( fmt->fallback ){
+      return snprintf( buf, size, fmt->src, val );
+   }
+   return format_run( fmt, NULL, val, buf, size );
+}
+
+/*
+ * return the secs between two changes of a time format : 1 if it
+ * shows the seconds or is left to libc, else 60, on the minute
+ */
+int format_period( const VfddFormat *fmt )
+{
+   int i;
+
+   if ( fmt->fallback ){
+      return 1;
+   }
+   for ( i = 0 ; i < fmt->op_num ; i++ ){
+      if ( fmt->ops[i].field == FIELD_SEC ){
+	 return 1;
+      }
+   }
+   return 60;
+}
@@ -0,0 +1,69 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/*
+ * format.h - display function formats compiled into a list of
+ *            literals and numeric fields.
+ *
+ * include LICENSE
+ */
+
+#include <time.h>
+
+#include <appclass.h>
+
+#define FORMAT_MAX_OPS 16       /* fields and literals of a format */
+
+enum _FormatKind {
+   FORMAT_TIME,                 /* strftime format */
+   FORMAT_INT,                  /* printf format of one int */
+};
+
+enum _FormatField {
+   FIELD_LIT,                   /* literal text */
+   FIELD_HOUR,
+   FIELD_HOUR12,
+   FIELD_AMPM,
+   FIELD_MIN,
+   FIELD_SEC,
+   FIELD_MDAY,
+   FIELD_MON,
+   FIELD_YEAR2,
+   FIELD_YEAR,
+   FIELD_YDAY,
+   FIELD_INT,                   /* the value of a FORMAT_INT */
+};
+
+typedef struct _FormatOp FormatOp;
+
+struct _FormatOp {
+   int field;                   /* FIELD_xxx */
+   int width;                   /* min width of a number */
+   char pad;                    /* '0' or ' ' */
+   const char *lit;             /* literal text of FIELD_LIT */
+   int len;                     /* literal length */
+};
+
+typedef struct _VfddFormat VfddFormat;
+
+struct _VfddFormat {
+   AppClass parent;
+   char *src;                   /* the format as configured */
+   int kind;                    /* FORMAT_TIME or FORMAT_INT */
+   int fallback;                /* 1 if libc formats it : a conversion is not compiled */
+   FormatOp ops[FORMAT_MAX_OPS];
+   int op_num;
+};
+
+/*
+ * prototypes
+ */
+VfddFormat *format_new( const char *src, int kind );
+void format_construct( VfddFormat *fmt, const char *src, int kind );
+void format_destroy(void *fmt);
+
+int format_time( VfddFormat *fmt, const struct tm *tm, char *buf, int size );
+int format_int( VfddFormat *fmt, int val, char *buf, int size );
+int format_period( const VfddFormat *fmt );
+
+#endif /* FORMAT_H */
@@ -0,0 +1,269 @@
+/*
+ * layout.c - lay a string out on the digits of a display.
+ *
+ *   On a segment display '.' and ',' light the decimal point of the
+ *   previous digit and ':' lights the colon, a dot matrix draws them.
+ *   Each UTF-8 character takes a digit, showing its font glyph.
+ *   A string longer than the display is truncated on the right, or on
+ *   the left when aligned right, unless it scrolls in a marquee strip.
+ *   A shorter one is padded with blanks.
+ *
+ *   Frames are cached by string hash : a clock or a temperature shows
+ *   a handful of distinct strings, each one is laid out once.
+ *
+ * include LICENSE
+ */
+#include <string.h>
+
+#include <layout.h>
+#include <strmem.h>
+
+/*
+ * local prototypes
+ */
+uint32_t layout_next_code( const uint8_t **s );
+int layout_cells( VfddLayout *lay, const char *str, uint32_t *cells,
+		  uint8_t *dps, int *colon );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddLayout object.
+ *  font : glyph images on the display bits
+ *  digit_num : number of digits
+ *  dp_bit : decimal point bit of a digit image, 0 if none
+ */
+
+VfddLayout *layout_new( const VfddFont *font, int digit_num, uint16_t dp_bit )
+{
+   VfddLayout *lay;
+
+   lay =  app_new0(VfddLayout, 1);
+   layout_construct( lay, font, digit_num, dp_bit );
+   app_class_overload_destroy( (AppClass *) lay, layout_destroy );
+   return lay;
+}
+
+/** \brief Constructor for the VfddLayout object. */
+
+void layout_construct( VfddLayout *lay, const VfddFont *font, int digit_num,
+		       uint16_t dp_bit )
+{
+   app_class_construct( (AppClass *) lay );
+
+   if ( digit_num > LAYOUT_MAX_DIGITS ){
+      msg_error( "%d digits, only %d are used", digit_num, LAYOUT_MAX_DIGITS );
+      digit_num = LAYOUT_MAX_DIGITS;
+   }
+   lay->font = font;
+   lay->digit_num = digit_num;
+   lay->dp_bit = dp_bit;
+   lay->cache = app_new0(LayoutFrame, LAYOUT_CACHE_SIZ );
+}
+
+/** \brief Destructor for the VfddLayout object. */
+
+void layout_destroy(void *lay)
+{
+   VfddLayout *this = (VfddLayout *) lay;
+
+   if (lay == NULL) {
+      return;
+   }
+   msg_dbg( "layout cache %lu hits %lu misses", this->hits, this->misses );
+   app_free(this->cache);
+
+   app_class_destroy( lay );
+}
+
+/*
+ * align : "left" (default) or "right"
+ */
+void layout_set_align( VfddLayout *lay, const char *align )
+{
+   lay->align_right = ( align && app_strcmp( align, "right" ) == 0 );
+}
+
+/*
+ * FNV-1a, never 0 which marks a free cache entry
+ */
+uint32_t layout_hash( const char *str )
+{
+   uint32_t h = 2166136261u;
+
+   while ( *str ){
+      h ^= (uint8_t) *str++;
+      h *= 16777619u;
+   }
+   return h ? h : 1;
+}
+
+/*
+ * return the code point of the UTF-8 character at *s and step over it,
+ * a malformed sequence is a blank
+ */
+uint32_t layout_next_code( const uint8_t **s )
+{
+   const uint8_t *p = *s;
+   uint32_t code = *p++;
+   int len = 0;
+
+   if ( code >= 0xF0 ){
+      code &= 0x07;
+      len = 3;
+   } else if ( code >= 0xE0 ){
+      code &= 0x0F;
+      len = 2;
+   } else if ( code >= 0xC0 ){
+      code &= 0x1F;
+      len = 1;
+   } else if ( code >= 0x80 ){
+      code = ' ';
+   }
+   for ( ; len > 0 ; len-- ){
+      if ( (*p & 0xC0) != 0x80 ){
+	 code = ' ';
+	 break;
+      }
+      code = code << 6 | (*p++ & 0x3F);
+   }
+   *s = p;
+   return code;
+}
+
+/*
+ * split str in cells, a code point and its decimal point each,
+ * return the number of cells
+ */
+int layout_cells( VfddLayout *lay, const char *str, uint32_t *cells,
+		  uint8_t *dps, int *colon )
+{
+   const uint8_t *s = (const uint8_t *) str;
+   int words = lay->font->words;
+   int n = 0;
+
+   *colon = 0;
+   while ( *s ){
+      uint32_t c = layout_next_code( &s );
+
+      if ( ( c == '.' || c == ',' ) && lay->dp_bit ){
+	 if ( n > 0 && ! dps[n - 1] ){
+	    dps[n - 1] = 1;
+	    continue;
+	 }
+	 c = ' ';
+	 if ( n < LAYOUT_MAX_CELLS ){
+	    cells[n] = c;
+	    dps[n++] = 1;
+	 }
+	 continue;
+      }
+      if ( c == ':' && words == 1 ){
+	 *colon = 1;
+	 continue;
+      }
+      if ( n < LAYOUT_MAX_CELLS ){
+	 cells[n] = c;
+	 dps[n++] = 0;
+      }
+   }
+   return n;
+}
+
+/*
+ * lay str out in fr
+ */
+void layout_render( VfddLayout *lay, const char *str, LayoutFrame *fr )
+{
+   uint32_t cells[LAYOUT_MAX_CELLS];
+   uint8_t dps[LAYOUT_MAX_CELLS];
+   int words = lay->font->words;
+   int n;
+   int i, w;
+
+   n = layout_cells( lay, str, cells, dps, &fr->colon );
+   fr->cells = n;
+
+   /* first cell shown, negative to pad on the left */
+   int first = 0;
+   if ( lay->align_right ){
+      first = n - lay->digit_num;
+   }
+
+   fr->text_ok = 1;
+   for ( i = 0 ; i < lay->digit_num ; i++ ){
+      int k = first + i;
+      uint32_t c = ' ';
+      uint16_t dot = 0;
+
+      if ( k >= 0 && k < n ){
+	 c = cells[k];
+	 dot = dps[k] ? lay->dp_bit : 0;
+      }
+      const uint16_t *image = font_glyph( lay->font, c );
+      for ( w = 0 ; w < words ; w++ ){
+	 fr->raw[i * words + w] = image[w];
+      }
+      fr->raw[i * words] |= dot;
+      fr->dots[i] = dot;
+      /* the driver only has glyphs for ' ' to '~' */
+      if ( c < ' ' || c > '~' ){
+	 fr->text_ok = 0;
+	 c = ' ';
+      }
+      fr->text[i] = c;
+   }
+}
+
+/*
+ * Lay str out in strip for a marquee : its cells, gap blanks, then its
+ * first digit_num cells again so that every window of digit_num cells
+ * starting before the period is contiguous. Return the period in cells.
+ */
+int layout_strip( VfddLayout *lay, const char *str, uint16_t *strip, int gap,
+		  int *colon )
+{
+   uint32_t cells[LAYOUT_MAX_CELLS];
+   uint8_t dps[LAYOUT_MAX_CELLS];
+   int words = lay->font->words;
+   int n;
+   int i, w;
+
+   n = layout_cells( lay, str, cells, dps, colon );
+   int period = n + gap;
+   for ( i = 0 ; i < period + lay->digit_num ; i++ ){
+      int k = i % period;
+      const uint16_t *image = font_glyph( lay->font, k < n ? cells[k] : ' ' );
+
+      for ( w = 0 ; w < words ; w++ ){
+	 strip[i * words + w] = image[w];
+      }
+      if ( k < n && dps[k] ){
+	 strip[i * words] |= lay->dp_bit;
+      }
+   }
+   return period;
+}
+
+/*
+ * return the frame of str, laid out once and cached
+ */
+const LayoutFrame *layout_get( VfddLayout *lay, const char *str )
+{
+   uint32_t h = layout_hash( str );
+   LayoutFrame *fr = &lay->cache[h & (LAYOUT_CACHE_SIZ - 1)];
+
+   if ( fr->hash == h && strcmp( fr->str, str ) == 0 ){
+      lay->hits++;
+      return fr;
+   }
+   lay->misses++;
+   if ( strlen( str ) >= sizeof(fr->str) ){
+      fr = &lay->tmp;
+      layout_render( lay, str, fr );
+      return fr;
+   }
+   layout_render( lay, str, fr );
+   fr->hash = h;
+   strcpy( fr->str, str );
+   return fr;
+}
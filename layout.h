@@ -0,0 +1,64 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+/*
+ * layout.h - lay a string out on the digits of a display,
+ *            folding punctuation into the neighbouring digit.
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+
+#include <appclass.h>
+#include <font.h>
+
+#define LAYOUT_MAX_DIGITS 16    /* max digits of a panel */
+#define LAYOUT_MAX_WORDS  (LAYOUT_MAX_DIGITS * FONT_MAX_WORDS)
+#define LAYOUT_MAX_CELLS  64    /* max cells of a string before truncation */
+#define LAYOUT_STR_SIZ    32    /* longer strings are laid out but not cached */
+#define LAYOUT_CACHE_SIZ  64    /* number of cached frames, power of 2 */
+
+typedef struct _LayoutFrame LayoutFrame;
+
+struct _LayoutFrame {
+   uint32_t hash;                     /* hash of str, 0 for a free entry */
+   char str[LAYOUT_STR_SIZ];          /* the string laid out */
+   char text[LAYOUT_MAX_DIGITS];      /* character shown by each digit */
+   uint16_t raw[LAYOUT_MAX_WORDS];    /* words of each digit with its point */
+   uint16_t dots[LAYOUT_MAX_DIGITS];  /* decimal point bit of each digit */
+   int colon;                         /* 1 if the colon is lit */
+   int cells;                         /* cells of the string, more than digits if truncated */
+   int text_ok;                       /* 1 if every digit shows a ' ' to '~' character */
+};
+
+typedef struct _VfddLayout VfddLayout;
+
+struct _VfddLayout {
+   AppClass parent;
+   const VfddFont *font;         /* glyph images on the display bits */
+   int digit_num;                /* number of digits */
+   uint16_t dp_bit;              /* decimal point bit in a digit image */
+   int align_right;              /* 1 to align right, truncating the left side */
+   LayoutFrame *cache;           /* frames indexed by string hash */
+   LayoutFrame tmp;              /* frame of a string too long to be cached */
+   unsigned long hits;           /* cache hits */
+   unsigned long misses;         /* strings laid out */
+};
+
+/*
+ * prototypes
+ */
+VfddLayout *layout_new( const VfddFont *font, int digit_num, uint16_t dp_bit );
+void layout_construct( VfddLayout *lay, const VfddFont *font, int digit_num,
+		       uint16_t dp_bit );
+void layout_destroy(void *lay);
+
+void layout_set_align( VfddLayout *lay, const char *align );
+uint32_t layout_hash( const char *str );
+void layout_render( VfddLayout *lay, const char *str, LayoutFrame *fr );
+const LayoutFrame *layout_get( VfddLayout *lay, const char *str );
+int layout_strip( VfddLayout *lay, const char *str, uint16_t *strip, int gap,
+		  int *colon );
+
+#endif /* LAYOUT_H */
@@ -0,0 +1,162 @@
+/*
+ * marquee.c - a string longer than the display scrolled across it.
+ *
+ *   The string is laid out once in a strip of display words. Each
+ *   step copies the next window of the strip to the layer showing it.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <marquee.h>
+#include <panel.h>
+#include <strmem.h>
+
+/* the marquee timer is idle this long when nothing scrolls */
+#define MARQUEE_IDLE_SEC 3600
+
+/*
+ * local prototypes
+ */
+void marquee_fill( VfddMarquee *mq );
+void marquee_arm( VfddMarquee *mq );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddMarquee object.
+ *  xpanel : the VfddPanel showing it
+ *  step : milisecs per step
+ */
+
+VfddMarquee *marquee_new( AppClass *xpanel, Loop *loop, int step )
+{
+   VfddMarquee *mq;
+
+   mq =  app_new0(VfddMarquee, 1);
+   marquee_construct( mq, xpanel, loop, step );
+   app_class_overload_destroy( (AppClass *) mq, marquee_destroy );
+   return mq;
+}
+
+/** \brief Constructor for the VfddMarquee object. */
+
+void marquee_construct( VfddMarquee *mq, AppClass *xpanel, Loop *loop, int step )
+{
+   app_class_construct( (AppClass *) mq );
+
+   mq->xpanel = xpanel;
+   mq->step = step;
+   mq->layer = -1;
+   mq->timer = timer_new( (AppClass *) mq, MARQUEE_IDLE_SEC * 1000,
+			  marquee_timer_cb, NULL );
+   loop_timer_add( loop, mq->timer );
+}
+
+/** \brief Destructor for the VfddMarquee object.
+ *  the timer belongs to the loop */
+
+void marquee_destroy(void *mq)
+{
+   VfddMarquee *this = (VfddMarquee *) mq;
+
+   if (mq == NULL) {
+      return;
+   }
+   msg_dbg( "marquee %lu steps %lu strips", this->steps, this->strips );
+   app_free(this->str);
+
+   app_class_destroy( mq );
+}
+
+/*
+ * copy the window at pos to the layer
+ */
+void marquee_fill( VfddMarquee *mq )
+{
+   VfddPanel *pa = (VfddPanel *) mq->xpanel;
+   uint16_t raw[COMPOSITOR_MAX_WORDS] = { 0 };
+   int words = pa->font->words;
+   const uint16_t *window = mq->strip + mq->pos * words;
+   int i;
+
+   for ( i = 0 ; i < pa->digit_num ; i++ ){
+      memcpy( &raw[pa->digit_map[i]], &window[i * words], words * sizeof(uint16_t) );
+   }
+   if ( mq->colon && pa->colon_word >= 0 ){
+      raw[pa->colon_word] |= pa->colon_bit;
+   }
+   compositor_set_words( pa->co, mq->layer, raw );
+}
+
+void marquee_arm( VfddMarquee *mq )
+{
+   struct timeval when;
+
+   gettimeofday( &when, NULL );
+   if ( mq->layer < 0 ){
+      when.tv_sec += MARQUEE_IDLE_SEC;
+   } else {
+      struct timeval step = { mq->step / 1000, (mq->step % 1000) * 1000 };
+      timeradd( &when, &step, &when );
+   }
+   timer_set_when( mq->timer, &when );
+}
+
+/*
+ * scroll str in layer, the panel composes it with its frame.
+ * The same string keeps scrolling, a new one in the same layer
+ * goes on from the same position.
+ */
+void marquee_set( VfddMarquee *mq, int layer, const char *str )
+{
+   VfddPanel *pa = (VfddPanel *) mq->xpanel;
+
+   if ( layer == mq->layer && app_strcmp( str, mq->str ) == 0 ){
+      return;
+   }
+   mq->period = layout_strip( pa->layout, str, mq->strip, MARQUEE_GAP,
+			      &mq->colon );
+   mq->strips++;
+   app_dup_str( &mq->str, (char *) str );
+   if ( layer != mq->layer ){
+      mq->pos = 0;
+      mq->layer = layer;
+      marquee_arm( mq );
+   }
+   mq->pos %= mq->period;
+   marquee_fill( mq );
+}
+
+/*
+ * stop scrolling if layer is scrolled
+ */
+void marquee_stop( VfddMarquee *mq, int layer )
+{
+   if ( layer != mq->layer ){
+      return;
+   }
+   mq->layer = -1;
+   marquee_arm( mq );
+}
+
+/*
+ * next step : show it now unless the frame prepared for the
+ * boundary is waiting, it is composed with it
+ */
+int marquee_timer_cb( AppClass *xmq, AppClass *user_data )
+{
+   VfddMarquee *mq = (VfddMarquee *) xmq;
+   VfddPanel *pa = (VfddPanel *) mq->xpanel;
+
+   if ( mq->layer >= 0 ){
+      mq->pos = ( mq->pos + 1 ) % mq->period;
+      mq->steps++;
+      marquee_fill( mq );
+      if ( compositor_compose( pa->co ) && ! pa->overlay_pending ){
+	 panel_overlay_store( pa );
+      }
+   }
+   marquee_arm( mq );
+   return 0;
+}
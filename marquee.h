@@ -0,0 +1,48 @@
+#ifndef MARQUEE_H
+#define MARQUEE_H
+
+/*
+ * marquee.h - a string longer than the display scrolled across it
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+
+#include <loop.h>
+#include <timerms.h>
+#include <layout.h>
+
+#define MARQUEE_GAP     3       /* blank cells between the end and the start */
+#define MARQUEE_STEP_MS 300     /* default time a window is shown */
+#define MARQUEE_MAX_CELLS (LAYOUT_MAX_CELLS + MARQUEE_GAP + LAYOUT_MAX_DIGITS)
+
+typedef struct _VfddMarquee VfddMarquee;
+
+struct _VfddMarquee {
+   AppClass parent;
+   AppClass *xpanel;            /* the VfddPanel showing it */
+   Timer *timer;                /* runs every step while scrolling */
+   int step;                    /* milisecs per step */
+   int layer;                   /* compositor layer scrolled, -1 if stopped */
+   char *str;                   /* the string in strip */
+   uint16_t strip[MARQUEE_MAX_CELLS * FONT_MAX_WORDS];  /* laid out string */
+   int period;                  /* cells before the strip repeats */
+   int pos;                     /* first cell shown */
+   int colon;                   /* 1 if the string lights the colon */
+   unsigned long steps;         /* windows shown */
+   unsigned long strips;        /* strings laid out */
+};
+
+/*
+ * prototypes
+ */
+VfddMarquee *marquee_new( AppClass *xpanel, Loop *loop, int step );
+void marquee_construct( VfddMarquee *mq, AppClass *xpanel, Loop *loop, int step );
+void marquee_destroy(void *mq);
+
+void marquee_set( VfddMarquee *mq, int layer, const char *str );
+void marquee_stop( VfddMarquee *mq, int layer );
+int marquee_timer_cb( AppClass *xmq, AppClass *user_data );
+
+#endif /* MARQUEE_H */
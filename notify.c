@@ -0,0 +1,345 @@
+/*
+ * notify.c - notifications shown instead of the display functions.
+ *
+ *   The live notifications are kept in two heaps : by priority, the
+ *   newest first within a priority, to find the one shown, and by
+ *   expiry to run one timer on the earliest end.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <notify.h>
+#include <strmem.h>
+#include <jsonroot.h>
+
+/* the notification timer is idle this long when nothing is queued */
+#define NOTIFY_IDLE_SEC 3600
+
+enum _NotifyHeap {
+   NOTIFY_BY_PRIO,
+   NOTIFY_BY_EXPIRE,
+   NOTIFY_HEAPS,
+};
+
+/*
+ * local prototypes
+ */
+int *notify_heap( VfddNotify *nt, int h );
+int *notify_pos( NotifyMsg *m, int h );
+int notify_above( VfddNotify *nt, int h, int a, int b );
+void notify_swap( VfddNotify *nt, int h, int i, int j );
+void notify_sift_up( VfddNotify *nt, int h, int i );
+void notify_sift_down( VfddNotify *nt, int h, int i );
+void notify_remove( VfddNotify *nt, int slot );
+void notify_arm( VfddNotify *nt );
+void notify_changed( VfddNotify *nt );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddNotify object.
+ *  loop : the loop running the expiry timer
+ */
+
+VfddNotify *notify_new( Loop *loop )
+{
+   VfddNotify *nt;
+
+   nt =  app_new0(VfddNotify, 1);
+   notify_construct( nt, loop );
+   app_class_overload_destroy( (AppClass *) nt, notify_destroy );
+   return nt;
+}
+
+/** \brief Constructor for the VfddNotify object. */
+
+void notify_construct( VfddNotify *nt, Loop *loop )
+{
+   app_class_construct( (AppClass *) nt );
+
+   nt->loop = loop;
+   nt->timer = timer_new( (AppClass *) nt, NOTIFY_IDLE_SEC * 1000,
+			  notify_timer_cb, NULL );
+   loop_timer_add( loop, nt->timer );
+}
+
+/** \brief Destructor for the VfddNotify object.
+ *  the timer belongs to the loop */
+
+void notify_destroy(void *nt)
+{
+   if (nt == NULL) {
+      return;
+   }
+
+   app_class_destroy( nt );
+}
+
+int *notify_heap( VfddNotify *nt, int h )
+{
+   return h == NOTIFY_BY_PRIO ? nt->by_prio : nt->by_expire;
+}
+
+int *notify_pos( NotifyMsg *m, int h )
+{
+   return h == NOTIFY_BY_PRIO ? &m->prio_pos : &m->expire_pos;
+}
+
+/*
+ * return 1 if msgs[a] goes above msgs[b] in heap h
+ */
+int notify_above( VfddNotify *nt, int h, int a, int b )
+{
+   NotifyMsg *ma = &nt->msgs[a];
+   NotifyMsg *mb = &nt->msgs[b];
+
+   if ( h == NOTIFY_BY_EXPIRE ){
+      return timercmp( &ma->expire, &mb->expire, < );
+   }
+   if ( ma->priority != mb->priority ){
+      return ma->priority > mb->priority;
+   }
+   return ma->seq > mb->seq;
+}
+
+void notify_swap( VfddNotify *nt, int h, int i, int j )
+{
+   int *heap = notify_heap( nt, h );
+   int tmp = heap[i];
+
+   heap[i] = heap[j];
+   heap[j] = tmp;
+   *notify_pos( &nt->msgs[heap[i]], h ) = i;
+   *notify_pos( &nt->msgs[heap[j]], h ) = j;
+}
+
+void notify_sift_up( VfddNotify *nt, int h, int i )
+{
+   int *heap = notify_heap( nt, h );
+
+   while ( i > 0 ){
+      int parent = (i - 1) / 2;
+      if ( ! notify_above( nt, h, heap[i], heap[parent] ) ){
+	 break;
+      }
+      notify_swap( nt, h, i, parent );
+      i = parent;
+   }
+}
+
+void notify_sift_down( VfddNotify *nt, int h, int i )
+{
+   int *heap = notify_heap( nt, h );
+
+   for ( ;; ){
+      int top = i;
+      int child = 2 * i + 1;
+
+      if ( child < nt->num && notify_above( nt, h, heap[child], heap[top] ) ){
+	 top = child;
+      }
+      child++;
+      if ( child < nt->num && notify_above( nt, h, heap[child], heap[top] ) ){
+	 top = child;
+      }
+      if ( top == i ){
+	 break;
+      }
+      notify_swap( nt, h, i, top );
+      i = top;
+   }
+}
+
+/*
+ * remove msgs[slot] from both heaps
+ */
+void notify_remove( VfddNotify *nt, int slot )
+{
+   int h;
+
+   nt->num--;
+   for ( h = 0 ; h < NOTIFY_HEAPS ; h++ ){
+      int *heap = notify_heap( nt, h );
+      int i = *notify_pos( &nt->msgs[slot], h );
+      int last = heap[nt->num];
+
+      heap[i] = last;
+      *notify_pos( &nt->msgs[last], h ) = i;
+      if ( i < nt->num ){
+	 notify_sift_up( nt, h, i );
+	 notify_sift_down( nt, h, i );
+      }
+   }
+   nt->msgs[slot].seq = 0;
+}
+
+/*
+ * run the timer on the earliest expiry
+ */
+void notify_arm( VfddNotify *nt )
+{
+   struct timeval when;
+
+   if ( nt->num ){
+      timer_set_when( nt->timer, &nt->msgs[nt->by_expire[0]].expire );
+      return;
+   }
+   gettimeofday( &when, NULL );
+   when.tv_sec += NOTIFY_IDLE_SEC;
+   timer_set_when( nt->timer, &when );
+}
+
+/*
+ * func( user_data, nt ) is called when the top notification may change
+ */
+void notify_set_changed_func( VfddNotify *nt, App_Run_FP func, void *user_data )
+{
+   nt->changed_func = func;
+   nt->changed_app = user_data;
+}
+
+void notify_changed( VfddNotify *nt )
+{
+   if ( nt->changed_func ){
+      nt->changed_func( nt->changed_app, nt );
+   }
+}
+
+/*
+ * show text for ttl_ms milisecs while no higher priority is queued,
+ * return its seq for notify_cancel, 0 if the queue is full and it is not queued
+ */
+unsigned long notify_push( VfddNotify *nt, int priority, int ttl_ms, const char *text,
+			  int flash )
+{
+   struct timeval ttl;
+   int slot;
+   int h;
+
+   for ( slot = 0 ; slot < NOTIFY_MAX ; slot++ ){
+      if ( nt->msgs[slot].seq == 0 ){
+	 break;
+      }
+   }
+   if ( slot == NOTIFY_MAX ){
+      msg_error( "%d notifications queued, '%s' dropped", NOTIFY_MAX, text );
+      return 0;
+   }
+
+   NotifyMsg *m = &nt->msgs[slot];
+   snprintf( m->text, sizeof(m->text), "%s", text );
+   m->priority = priority;
+   m->flash = flash;
+   /* 0 is a free slot and "not queued", skip it when the count wraps */
+   if ( ++nt->seq == 0 ){
+      nt->seq++;
+   }
+   m->seq = nt->seq;
+   gettimeofday( &m->expire, NULL );
+   ttl.tv_sec = ttl_ms / 1000;
+   ttl.tv_usec = (ttl_ms % 1000) * 1000;
+   timeradd( &m->expire, &ttl, &m->expire );
+
+   for ( h = 0 ; h < NOTIFY_HEAPS ; h++ ){
+      notify_heap( nt, h )[nt->num] = slot;
+      *notify_pos( m, h ) = nt->num;
+   }
+   nt->num++;
+   for ( h = 0 ; h < NOTIFY_HEAPS ; h++ ){
+      notify_sift_up( nt, h, nt->num - 1 );
+   }
+   notify_arm( nt );
+   notify_changed( nt );
+   msg_dbg( "notify '%s' priority %d for %d ms", m->text, priority, ttl_ms );
+   return m->seq;
+}
+
+/*
+ * drop the notification seq if it is still queued
+ */
+void notify_cancel( VfddNotify *nt, unsigned long seq )
+{
+   int slot;
+
+   for ( slot = 0 ; slot < NOTIFY_MAX ; slot++ ){
+      if ( seq && nt->msgs[slot].seq == seq ){
+	 notify_remove( nt, slot );
+	 notify_arm( nt );
+	 notify_changed( nt );
+	 return;
+      }
+   }
+}
+
+void notify_clear( VfddNotify *nt )
+{
+   int slot;
+
+   for ( slot = 0 ; slot < NOTIFY_MAX ; slot++ ){
+      nt->msgs[slot].seq = 0;
+   }
+   nt->num = 0;
+   notify_arm( nt );
+   notify_changed( nt );
+}
+
+/*
+ * return the notification to show, NULL if none
+ */
+const NotifyMsg *notify_top( VfddNotify *nt )
+{
+   return nt->num ? &nt->msgs[nt->by_prio[0]] : NULL;
+}
+
+/*
+ * the earliest notification has expired
+ */
+int notify_timer_cb( AppClass *xnt, AppClass *user_data )
+{
+   VfddNotify *nt = (VfddNotify *) xnt;
+   struct timeval now;
+   int expired = 0;
+
+   gettimeofday( &now, NULL );
+   while ( nt->num ){
+      int slot = nt->by_expire[0];
+      if ( timercmp( &nt->msgs[slot].expire, &now, > ) ){
+	 break;
+      }
+      msg_dbg( "notify '%s' expired", nt->msgs[slot].text );
+      notify_remove( nt, slot );
+      expired++;
+   }
+   notify_arm( nt );
+   if ( expired ){
+      notify_changed( nt );
+   }
+   return 0;
+}
+
+/*
+ * "notifications" : [ { "text": "HELLO", "priority": 1, "ttl": 5 }, ... ]
+ * ttl in seconds
+ */
+int notify_iter_conf( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   VfddNotify *nt = (VfddNotify *) user_data;
+   char *text;
+   int priority;
+   int ttl;
+
+   json_root_get_item_string( node, "text", &text );
+   if ( ! text ){
+      msg_error( "notification without text" );
+      return 0;
+   }
+   json_root_get_item_int( node, "priority", &priority );
+   json_root_get_item_int( node, "ttl", &ttl );
+   if ( ttl > NOTIFY_TTL_MAX ){
+      ttl = NOTIFY_TTL_MAX;
+   }
+   notify_push( nt, priority, ttl * 1000, text, 0 );
+   return 0;
+}
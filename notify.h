@@ -0,0 +1,64 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+/*
+ * notify.h - notifications shown instead of the display functions
+ *            until they expire, the highest priority first.
+ *
+ * include LICENSE
+ */
+
+#include <limits.h>
+#include <sys/time.h>
+
+#include <loop.h>
+#include <timerms.h>
+
+#define NOTIFY_MAX      32      /* live notifications */
+#define NOTIFY_TEXT_SIZ 64      /* max length of a notification text */
+#define NOTIFY_TTL_MAX  ( INT_MAX / 1000 ) /* secs, the ttl is passed in milisecs */
+
+typedef struct _NotifyMsg NotifyMsg;
+
+struct _NotifyMsg {
+   char text[NOTIFY_TEXT_SIZ];  /* the string shown */
+   int priority;                /* the highest one is shown */
+   int flash;                   /* 1 if shown every other boundary */
+   struct timeval expire;       /* time the notification ends */
+   unsigned long seq;           /* push order, 0 for a free slot */
+   int prio_pos;                /* index in by_prio */
+   int expire_pos;              /* index in by_expire */
+};
+
+typedef struct _VfddNotify VfddNotify;
+
+struct _VfddNotify {
+   AppClass parent;
+   Loop *loop;                  /* the loop running timer */
+   Timer *timer;                /* runs on the earliest expiry */
+   NotifyMsg msgs[NOTIFY_MAX];
+   int by_prio[NOTIFY_MAX];     /* heap of msgs indexes, highest priority on top */
+   int by_expire[NOTIFY_MAX];   /* heap of msgs indexes, earliest expiry on top */
+   int num;                     /* live notifications */
+   unsigned long seq;           /* last push number */
+   App_Run_FP changed_func;     /* called when the top notification may change */
+   void *changed_app;
+};
+
+/*
+ * prototypes
+ */
+VfddNotify *notify_new( Loop *loop );
+void notify_construct( VfddNotify *nt, Loop *loop );
+void notify_destroy(void *nt);
+
+void notify_set_changed_func( VfddNotify *nt, App_Run_FP func, void *user_data );
+unsigned long notify_push( VfddNotify *nt, int priority, int ttl_ms, const char *text,
+			  int flash );
+void notify_cancel( VfddNotify *nt, unsigned long seq );
+void notify_clear( VfddNotify *nt );
+const NotifyMsg *notify_top( VfddNotify *nt );
+int notify_timer_cb( AppClass *xnt, AppClass *user_data );
+int notify_iter_conf( AppClass *data, void *user_data );
+
+#endif /* NOTIFY_H */
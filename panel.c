@@ -0,0 +1,634 @@
+/*
+ * panel.c - one led display driven by the daemon : its device files,
+ *           grid layout, display functions and dotleds.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <panel.h>
+#include <dotled.h>
+#include <diskstats.h>
+#include <display.h>
+#include <duprintf.h>
+
+/* characters uploaded to the driver glyphs table : ' ' to '~' */
+#define GLYPHS_FIRST ' '
+#define GLYPHS_COUNT ('~' - ' ' + 1)
+
+/*
+ * local prototypes
+ */
+void panel_read_display( VfddPanel *pa, JsonNode *node );
+void panel_read_dotleds( VfddPanel *pa, JsonNode *node );
+void panel_check_text_order( VfddPanel *pa );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddPanel object.
+ *  xnode : configuration node holding "display" and "dotleds"
+ *  num : panel number
+ */
+
+VfddPanel *panel_new( AppClass *xnode, Vfdd *vf, int num )
+{
+   VfddPanel *pa;
+
+   pa =  app_new0(VfddPanel, 1);
+   panel_construct( pa, xnode, vf, num );
+   app_class_overload_destroy( (AppClass *) pa, panel_destroy );
+   return pa;
+}
+
+/** \brief Constructor for the VfddPanel object. */
+
+void panel_construct( VfddPanel *pa, AppClass *xnode, Vfdd *vf, int num )
+{
+   JsonNode *root = (JsonNode *) xnode;
+   JsonNode *node;
+   char *name;
+
+   app_class_construct( (AppClass *) pa );
+   pa->vf = vf;
+   pa->colon_word = -1;
+
+   json_root_get_item_string(root, "name", &name );
+   if ( name ){
+      pa->name = app_strdup(name);
+   } else {
+      pa->name = app_strdup_printf("panel%d", num);
+   }
+
+   node = json_node_find_node( root, "display" );
+   if ( node ) {
+      panel_read_display( pa, node );
+   }
+   node = json_node_find_node( root, "dotleds" );
+   if ( node ) {
+      panel_read_dotleds( pa, node );
+   }
+
+   /* let the driver render the text if it takes our glyphs */
+   if ( ! pa->glyphs || panel_glyphs_store( pa ) < 0 ){
+      app_free( pa->text );
+      pa->text = NULL;
+   } else {
+      panel_check_text_order( pa );
+   }
+
+   DotLed *led = (DotLed *) dlist_lookup( pa->dots, (AppClass *) "colon",
+					  dotled_name_str_cmp );
+   if ( led ) {
+      dotled_set_cb_func( led, vfdd_get_colon, vf );
+      /* a ':' in the string lights it too */
+      if ( pa->colon_word < 0 ){
+	 pa->colon_word = led->word;
+	 pa->colon_bit = 1 << led->bit;
+      }
+   }
+}
+
+/** \brief Destructor for the VfddPanel object. */
+
+void panel_destroy(void *pa)
+{
+   VfddPanel *this = (VfddPanel *) pa;
+
+   if (pa == NULL) {
+      return;
+   }
+   dlist_delete_all( this->dots );
+   rotation_destroy( this->rotation );
+   marquee_destroy( this->marquee );
+   layout_destroy( this->layout );
+   compositor_destroy( this->co );
+   app_free(this->name);
+   app_free(this->device);
+   app_free(this->overlay);
+   app_free(this->glyphs);
+   app_free(this->text);
+   font_destroy(this->font);
+   app_free(this->display_raw);
+   app_free(this->digit_map);
+   app_free(this->display_str);
+
+   app_class_destroy( pa );
+}
+
+int panel_iter_dotled_funcs( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   VfddPanel *pa = (VfddPanel *) user_data;
+   int result;
+
+   JsonNode *n = json_root_get_item_bool(node, "enable",  &result );
+   if ( n == NULL || result == 0 ){
+      return 0;
+   }
+
+   if ( dotled_set_kernel_trigger( (AppClass *) node ) ){
+      return 0;
+   }
+
+   DotLed *led = dotled_new( (AppClass *) node, pa->co, pa->dotled_map );
+   pa->dots = dlist_add_tail(pa->dots, (AppClass *) led );
+   if ( led->sysfile ){
+      led->src = source_get( pa->vf, led->sysfile );
+      source_conf_bounds( led->src, node );
+   }
+   if ( led->device ){
+      if ( ! pa->vf->disks ){
+	 pa->vf->disks = diskstats_new( pa->vf );
+      }
+      led->disk = diskstats_add( pa->vf->disks, led->device );
+   }
+
+   msg_dbg( "%s dotled '%s' %d \n", pa->name, node->keyname, pa->dotled_map );
+   return 0;
+}
+
+int panel_iter_display_funcs( AppClass *data, void *user_data )
+{
+   JsonNode *node = (JsonNode *) data;
+   VfddPanel *pa = (VfddPanel *) user_data;
+   int result;
+
+   JsonNode *n = json_root_get_item_bool(node, "enable",  &result );
+   if ( n == NULL || result == 0 ){
+      return 0;
+   }
+
+   VfddDisplay *dis = display_new( (AppClass *) node, (AppClass *) pa );
+   rotation_add( pa->rotation, dis );
+
+   msg_dbg( "%s vfdd_funcd '%s'\n", pa->name, node->keyname );
+   return 0;
+}
+
+void panel_read_display( VfddPanel *pa, JsonNode *node )
+{
+   char *name;
+   int count;
+   int i;
+
+   json_root_get_item_string(node, "device", &name );
+   if ( name ){
+      pa->device = app_strdup(name);
+   }
+   json_root_get_item_string(node, "sysfile", &name );
+   if ( name ){
+      pa->overlay = app_strdup_printf("%s/%s", pa->device, name);
+   }
+   json_root_get_item_string(node, "glyphs_sysfile", &name );
+   if ( name ){
+      pa->glyphs = app_strdup_printf("%s/%s", pa->device, name);
+   }
+   json_root_get_item_string(node, "text_sysfile", &name );
+   if ( name ){
+      pa->text = app_strdup_printf("%s/%s", pa->device, name);
+   }
+
+   json_root_get_item_int( node, "grid_num", &pa->grid_num );
+   if ( pa->grid_num > COMPOSITOR_MAX_WORDS ){
+      msg_error("%s grid_num %d, only %d are used", pa->name, pa->grid_num,
+		COMPOSITOR_MAX_WORDS );
+      pa->grid_num = COMPOSITOR_MAX_WORDS;
+   }
+   pa->display_raw = app_new0(uint16_t, pa->grid_num );
+   pa->co = compositor_new( pa->grid_num, pa->display_raw );
+
+   /* segments : 7 (default), 14, 16, or 35 for a 5x7 dot matrix */
+   int segments;
+   if ( ! json_root_get_item_int( node, "segments", &segments ) ){
+      segments = 7;
+   }
+
+   /* segno : bit num for segment a b c ... then the decimal point,
+    * rows from the top for a dot matrix, default 1 to 1 */
+   uint8_t segno[FONT_MAX_BITS + 1];
+   int segno_num = 0;
+   for ( i = 0 ; i < (int) sizeof(segno) ; i++ ){
+      segno[i] = i;
+   }
+   JsonNode *array = json_root_get_item_nelem( node, "segment_no", &count);
+   if ( array ){
+      for ( i = 0 ; i < count && i < (int) sizeof(segno) ; i++ ){
+	 JsonNode *item = json_node_get_nth_child( array, i );
+	 if ( ! item ){
+	    continue;
+	 }
+	 int val;
+	 json_node_get_val_int(item, &val );
+	 segno[i] = val & 0xF;
+      }
+      segno_num = i;
+   }
+   json_root_get_item_string(node, "font", &name );
+   panel_init_font ( pa, segments, name, segno);
+   int words = pa->font->words;
+
+   array = json_root_get_item_nelem( node, "digit_map", &count);
+   if ( array ){
+      pa->digit_num = count ;
+      pa->digit_map = app_new0( uint8_t, count );
+      for ( i = 0 ; i < count ; i++ ){
+	 JsonNode *item = json_node_get_nth_child( array, i );
+	 if ( ! item ){
+	    continue;
+	 }
+	 int val;
+	 json_node_get_val_int(item, &val );
+	 if ( val < 0 || val + words > pa->grid_num ){
+	    msg_error("%s digit_map[%d] = %d is not a grid address", pa->name, i, val );
+	    val = 0;
+	 }
+	 pa->digit_map[i] = val;
+      }
+   }
+
+   /* the entry after the segments is the decimal point,
+    * there is no room for it by default on a 16-segment word */
+   uint16_t dp_bit = 0;
+   if ( words == 1 && ( segno_num > pa->font->bits || pa->font->bits < FONT_MAX_BITS ) ){
+      dp_bit = 1 << segno[pa->font->bits];
+   }
+   pa->layout = layout_new( pa->font, pa->digit_num, dp_bit );
+   json_root_get_item_string(node, "align", &name );
+   layout_set_align( pa->layout, name );
+
+   /* "marquee_ms" : time per step of a scrolled string, 0 to truncate it */
+   int step;
+   if ( ! json_root_get_item_int( node, "marquee_ms", &step ) ){
+      step = MARQUEE_STEP_MS;
+   }
+   if ( step > 0 ){
+      pa->marquee = marquee_new( (AppClass *) pa, pa->vf->loop, step );
+   }
+   if ( pa->digit_num > pa->layout->digit_num ){
+      pa->digit_num = pa->layout->digit_num;
+   }
+
+   /* "colon" : [ word, bit ] , default the colon dotled */
+   array = json_root_get_item_nelem( node, "colon", &count);
+   if ( array && count == 2 ){
+      int word, bit;
+      json_node_get_val_int( json_node_get_nth_child( array, 0 ), &word );
+      json_node_get_val_int( json_node_get_nth_child( array, 1 ), &bit );
+      if ( word >= 0 && word < pa->grid_num ){
+	 pa->colon_word = word;
+	 pa->colon_bit = 1 << bit;
+      }
+   }
+
+   json_root_get_item_int( node, "brightness", &pa->brightness );
+
+   /* "rotation_period" : secs between two runs of the function slots */
+   int period;
+   json_root_get_item_int( node, "rotation_period", &period );
+   pa->rotation = rotation_new( period );
+
+   JsonNode *object = json_node_find_node( node, "functions");
+   if ( object ){
+      dlist_iterator(object->child, panel_iter_display_funcs, pa );
+   }
+}
+
+void panel_read_dotleds( VfddPanel *pa, JsonNode *node )
+{
+   json_root_get_item_int( node, "grid_map", &pa->dotled_map );
+   if ( pa->dotled_map < 0 || pa->dotled_map >= pa->grid_num ){
+      msg_error("%s dotleds grid_map %d is not a grid address", pa->name, pa->dotled_map );
+      return;
+   }
+
+   JsonNode *object = json_node_find_node( node, "functions" );
+   if ( object ){
+      dlist_iterator(object->child, panel_iter_dotled_funcs, pa );
+   }
+
+}
+
+/*
+ * Load the font of the display, from the font file path if any,
+ * and remap its glyph images on the display bits : segment j of
+ * the glyph image lights bit segno[j] of the display word.
+ */
+void panel_init_font ( VfddPanel *pa, int segments, const char *path,
+		       const uint8_t *segno )
+{
+   VfddFont *font = NULL;
+
+   if ( path ){
+      font = font_load( path );
+      if ( font && font->segments != segments ){
+	 msg_error("%s : font '%s' has %d segments, not %d", pa->name, path,
+		   font->segments, segments );
+	 font_destroy( font );
+	 font = NULL;
+      }
+   }
+   if ( ! font ){
+      font = font_new( segments );
+   }
+   font_destroy( pa->font );
+   pa->font = font_remap( font, segno );
+   font_destroy( font );
+   msg_dbg( "%s : font %s, %d segments", pa->name, pa->font->name, pa->font->segments );
+}
+
+/*
+ * Copy the laid out digit images to the display words :
+ * digit i goes to ram address digit_map[i] and the next ones
+ * for a glyph of several words.
+ */
+void panel_update_display (VfddPanel *pa, const LayoutFrame *fr, uint16_t *raw )
+{
+   int i, w;
+   int words = pa->font->words;
+
+   for (i = 0; i < pa->digit_num; i++) {
+      for (w = 0; w < words; w++) {
+	 raw[pa->digit_map[i] + w] = fr->raw[i * words + w];
+      }
+   }
+}
+
+void panel_overlay_store (VfddPanel *pa )
+{
+   int i;
+
+   FILE *fd = fopen( pa->overlay, "w");
+   if ( ! fd ){
+      msg_error("Failed to open file '%s' - %s", pa->overlay, strerror(errno) );
+      return;
+   }
+   msg_dbg( "writing to '%s'", pa->overlay );
+   for (i = 0; i < pa->grid_num; i++) {
+      fprintf(fd, "%04X ", pa->display_raw[i] ) ;
+   }
+   fclose(fd);
+}
+
+/*
+ * Upload the glyph images to the driver, one 16-bit word per character
+ * from ' ' to '~'. Returns 0 if the driver renders the text from now on.
+ */
+int panel_glyphs_store (VfddPanel *pa )
+{
+   uint16_t image[GLYPHS_COUNT];
+   int i;
+
+   if ( pa->font->words != 1 ){
+      msg_info("No glyph upload to '%s' - %d words per glyph", pa->glyphs,
+	       pa->font->words );
+      return -1;
+   }
+   for (i = 0; i < GLYPHS_COUNT; i++) {
+      image[i] = font_glyph( pa->font, GLYPHS_FIRST + i )[0];
+   }
+
+   FILE *fd = fopen( pa->glyphs, "w");
+   if ( ! fd ){
+      msg_info("No glyph upload to '%s' - %s", pa->glyphs, strerror(errno) );
+      return -1;
+   }
+   size_t n = fwrite( image, sizeof(image), 1, fd );
+   /* the driver reports an error on close */
+   if ( fclose(fd) != 0 || n != 1 ){
+      msg_info("No glyph upload to '%s' - %s", pa->glyphs, strerror(errno) );
+      return -1;
+   }
+   msg_dbg( "glyphs uploaded to '%s'", pa->glyphs );
+   return 0;
+}
+
+/*
+ * The driver renders character i of its text on the word grid_num[i] of
+ * the device tree : it then takes the text in digit order, placing it by
+ * digit_map too would move the characters twice. digit_map still places
+ * the decimal points and the raw frames : digit_map[i] must be the word
+ * the driver shows character i on.
+ */
+void panel_check_text_order( VfddPanel *pa )
+{
+   char *path = app_strdup_printf( "%s/of_node/grid_num", pa->device );
+   int i;
+
+   pa->text_ordered = access( path, R_OK ) == 0;
+   app_free(path);
+   if ( ! pa->text_ordered ){
+      return;
+   }
+   for ( i = 0 ; i < pa->digit_num ; i++ ){
+      if ( pa->digit_map[i] != i ){
+	 msg_warning( "%s : the driver maps the text cells with grid_num, "
+		      "digit_map only places the dots and raw frames", pa->name );
+	 break;
+      }
+   }
+}
+
+/*
+ * Lay the text out for the driver which renders it with the uploaded glyphs.
+ * Character i goes to the cell digit_map[i], or i when the driver maps the
+ * cells itself, the decimal points go to raw. A frame with a character the
+ * driver has no glyph for goes to raw under a blank text.
+ */
+void panel_update_text (VfddPanel *pa, const LayoutFrame *fr, uint16_t *raw )
+{
+   char *text = pa->text_buf;
+   int i;
+   int len = 0;
+
+   memset( text, 0, sizeof(pa->text_buf) );
+
+   /* the driver ORs the decimal points from the overlay */
+   for (i = 0; i < pa->digit_num; i++) {
+      int k = pa->digit_map[i];
+      int t = pa->text_ordered ? i : k;
+      if ( fr->text_ok ){
+	 text[t] = fr->text[i];
+	 raw[k] |= fr->dots[i];
+      } else {
+	 text[t] = ' ';
+	 raw[k] |= fr->raw[i];
+      }
+      if ( t >= len ){
+	 len = t + 1;
+      }
+   }
+   for (i = 0; i < len; i++) {
+      if ( ! text[i] ){
+	 text[i] = ' ';
+      }
+   }
+   pa->text_len = len;
+   pa->text_pending = 1;
+}
+
+/*
+ * Write the text laid out to the driver
+ */
+void panel_text_store (VfddPanel *pa )
+{
+   FILE *fd = fopen( pa->text, "w");
+   if ( ! fd ){
+      msg_error("Failed to open file '%s' - %s", pa->text, strerror(errno) );
+      return;
+   }
+   msg_dbgl( DBG_2, "writing '%.*s' to '%s'", pa->text_len, pa->text_buf, pa->text );
+   fwrite( pa->text_buf, 1, pa->text_len, fd );
+   fclose(fd);
+}
+
+/*
+ * Build the text layer from the laid out frame of str. In text mode the
+ * driver draws the characters and the layer holds the rest.
+ * A string longer than the display scrolls in the layer.
+ */
+void panel_text_layer( VfddPanel *pa, const char *str, const LayoutFrame *fr )
+{
+   uint16_t raw[COMPOSITOR_MAX_WORDS] = { 0 };
+
+   if ( pa->marquee && fr->cells > pa->digit_num ){
+      if ( pa->text ){
+	 panel_update_text ( pa, layout_get( pa->layout, "" ), raw );
+      }
+      marquee_set( pa->marquee, LAYER_TEXT, str );
+      return;
+   }
+   if ( pa->marquee ){
+      marquee_stop( pa->marquee, LAYER_TEXT );
+   }
+   if ( pa->text ){
+      panel_update_text ( pa, fr, raw );
+   } else {
+      panel_update_display ( pa, fr, raw );
+   }
+   if ( fr->colon && pa->colon_word >= 0 ){
+      raw[pa->colon_word] |= pa->colon_bit;
+   }
+   compositor_set_words( pa->co, LAYER_TEXT, raw );
+}
+
+/*
+ * Show msg in the notify layer over the hidden text layer, or give
+ * the display back to the text layer if msg is NULL. In text mode
+ * the driver text is blanked under the notification.
+ */
+void panel_notify_layer( VfddPanel *pa, const NotifyMsg *msg )
+{
+   uint16_t raw[COMPOSITOR_MAX_WORDS] = { 0 };
+   /* the text cells are blanked, the words laid out under them are dropped */
+   uint16_t under[COMPOSITOR_MAX_WORDS] = { 0 };
+
+   compositor_show_layer( pa->co, LAYER_TEXT, msg == NULL );
+   if ( ! msg ){
+      if ( pa->marquee ){
+	 marquee_stop( pa->marquee, LAYER_NOTIFY );
+      }
+      compositor_set_words( pa->co, LAYER_NOTIFY, raw );
+      /* the text layer is laid out again */
+      pa->frame = NULL;
+      return;
+   }
+   msg_dbgl( DBG_2, "%s notification '%s'", pa->name, msg->text );
+   if ( pa->text ){
+      panel_update_text ( pa, layout_get( pa->layout, "" ), under );
+   }
+
+   const LayoutFrame *fr = layout_get( pa->layout, msg->text );
+   if ( pa->marquee && fr->cells > pa->digit_num ){
+      marquee_set( pa->marquee, LAYER_NOTIFY, msg->text );
+      return;
+   }
+   if ( pa->marquee ){
+      marquee_stop( pa->marquee, LAYER_NOTIFY );
+   }
+   panel_update_display ( pa, fr, raw );
+   if ( fr->colon && pa->colon_word >= 0 ){
+      raw[pa->colon_word] |= pa->colon_bit;
+   }
+   compositor_set_words( pa->co, LAYER_NOTIFY, raw );
+}
+
+/*
+ * ahead of a boundary : the daemon has set the time of the boundary,
+ * update the layers and compose the frame
+ */
+int panel_iter_prepare( AppClass *data, void *user_data )
+{
+   VfddPanel *pa = (VfddPanel *) data;
+   Vfdd *vf = pa->vf;
+
+   /* the function shown is formatted when it may have changed */
+   if ( pa->rotation &&
+	rotation_update( pa->rotation, vf->curtime, vf->vftm->tm_gmtoff ) &&
+	! pa->rotation->shown ){
+      app_dup_str( &pa->display_str, "" );
+   }
+   /* each sysfile is read when its poll is due */
+   dlist_iterator(pa->dots, dotled_iter_update, vf );
+
+   /* the highest priority notification hides the text layer */
+   const NotifyMsg *msg = pa->vf->word ? NULL : notify_top( pa->vf->notify );
+   unsigned long seq = msg ? msg->seq : 0;
+   if ( seq != pa->notify_seq ){
+      panel_notify_layer( pa, msg );
+      pa->notify_seq = seq;
+   }
+
+   char *dstr = pa->vf->word ? pa->vf->word : pa->display_str;
+   const LayoutFrame *fr = layout_get( pa->layout, dstr ? dstr : "" );
+
+   /* a cached frame keeps its address and hash while the string is the same */
+   if ( seq == 0 &&
+	( fr != pa->frame || fr->hash != pa->frame_hash || fr->hash == 0 ) ){
+      msg_dbgl( DBG_2, "%s showing '%s'", pa->name, dstr );
+      panel_text_layer( pa, dstr ? dstr : "", fr );
+      pa->frame = fr;
+      pa->frame_hash = fr->hash;
+   }
+   /* the blink layer and a flashing notification show every other boundary */
+   compositor_show_layer( pa->co, LAYER_BLINK, vf->phase );
+   compositor_show_layer( pa->co, LAYER_NOTIFY, ! msg || ! msg->flash || vf->phase );
+
+   if ( compositor_compose( pa->co ) ){
+      pa->overlay_pending = 1;
+   }
+
+   /* the next boundary with a change, blinking needs all of them */
+   if ( pa->rotation ){
+      struct timeval due = { pa->rotation->due, 0 };
+      vfdd_set_due( vf, &due );
+   }
+   dlist_iterator(pa->dots, dotled_iter_due, vf );
+   if ( pa->co->layers[LAYER_BLINK].used || ( msg && msg->flash ) ){
+      vfdd_set_due( vf, &vf->tick );
+   }
+   return 0;
+}
+
+/*
+ * on the boundary : write what was prepared
+ */
+int panel_iter_commit( AppClass *data, void *user_data )
+{
+   VfddPanel *pa = (VfddPanel *) data;
+   Vfdd *vf = (Vfdd *) user_data;
+
+   if ( pa->text_pending ){
+      panel_text_store ( pa );
+      pa->text_pending = 0;
+      vf->writes++;
+   }
+   if ( pa->overlay_pending ){
+      panel_overlay_store ( pa );
+      pa->overlay_pending = 0;
+      vf->writes++;
+   }
+   return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+/*
+ * panel.h - one led display driven by the daemon
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+
+#include <vfdd.h>
+#include <layout.h>
+#include <compositor.h>
+#include <marquee.h>
+#include <rotation.h>
+
+typedef struct _VfddPanel VfddPanel;
+
+struct _VfddPanel {
+   AppClass parent;
+   Vfdd *vf;               /* the daemon object */
+   char *name;             /* panel name for messages */
+   uint16_t *display_raw;  /* data to be transmitted to display */
+   VfddCompositor *co;     /* layers composited in display_raw */
+   DList *dots;            /* list of dotled object */
+   VfddRotation *rotation; /* display functions in turn, NULL without display */
+   VfddFont *font;         /* glyph images on the display bits */
+   VfddLayout *layout;     /* string to digits layout, with its frame cache */
+   VfddMarquee *marquee;   /* scrolls the strings longer than the display, NULL if off */
+   const LayoutFrame *frame;  /* frame in the text layer */
+   uint32_t frame_hash;    /* hash of the frame string when it was laid out */
+   unsigned long notify_seq;  /* notification in the notify layer, 0 if none */
+   int colon_word;         /* display word of the colon, -1 if none */
+   uint16_t colon_bit;     /* colon bit in colon_word */
+   uint8_t *digit_map;     /* table of digit address */
+   char *device;           /* vfd device name */
+   char *overlay;          /* name of the overlay sys file */
+   char *glyphs;           /* name of the glyphs sys file */
+   char *text;             /* name of the display sys file, set once glyphs are uploaded */
+   char *display_str;      /* sting to be displayed */
+   char text_buf[COMPOSITOR_MAX_WORDS];  /* text prepared for the text sys file */
+   int text_len;           /* length of text_buf */
+   int text_pending;       /* 1 if text_buf must be written */
+   int text_ordered;       /* 1 if the driver maps the text cells (grid_num in the device tree) */
+   int overlay_pending;    /* 1 if display_raw must be written */
+   int digit_num;          /* number of digit in display */
+   int grid_num;           /* number of ram address in display */
+   int dotled_map;         /* ram address for dotleds */
+   int brightness;         /* default led brightness (0 to 100%) */
+};
+
+/*
+ * prototypes
+ */
+VfddPanel *panel_new( AppClass *xnode, Vfdd *vf, int num );
+void panel_construct( VfddPanel *pa, AppClass *xnode, Vfdd *vf, int num );
+void panel_destroy(void *pa);
+
+int panel_iter_prepare( AppClass *data, void *user_data );
+int panel_iter_commit( AppClass *data, void *user_data );
+int panel_iter_dotled_funcs( AppClass *data, void *user_data );
+int panel_iter_display_funcs( AppClass *data, void *user_data );
+void panel_init_font( VfddPanel *pa, int segments, const char *path,
+		      const uint8_t *segno );
+void panel_update_display( VfddPanel *pa, const LayoutFrame *fr, uint16_t *raw );
+void panel_overlay_store( VfddPanel *pa );
+int panel_glyphs_store( VfddPanel *pa );
+void panel_update_text( VfddPanel *pa, const LayoutFrame *fr, uint16_t *raw );
+void panel_text_store( VfddPanel *pa );
+void panel_text_layer( VfddPanel *pa, const char *str, const LayoutFrame *fr );
+void panel_notify_layer( VfddPanel *pa, const NotifyMsg *msg );
+
+#endif /* PANEL_H */
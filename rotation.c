@@ -0,0 +1,154 @@
+/*
+ * rotation.c - display functions shown in turn.
+ *
+ *   Each function has a slot in the period, the highest priority
+ *   slot holding the current second is shown. Only the shown
+ *   function is formatted, and only when it may change : on a slot
+ *   edge showing another function, or on its next refresh.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <rotation.h>
+#include <strmem.h>
+
+/*
+ * local prototypes
+ */
+int rotation_phase( VfddRotation *rot, time_t t, long gmtoff );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddRotation object.
+ *  period : secs between two runs of the slots
+ */
+
+VfddRotation *rotation_new( int period )
+{
+   VfddRotation *rot;
+
+   rot =  app_new0(VfddRotation, 1);
+   rotation_construct( rot, period );
+   app_class_overload_destroy( (AppClass *) rot, rotation_destroy );
+   return rot;
+}
+
+/** \brief Constructor for the VfddRotation object. */
+
+void rotation_construct( VfddRotation *rot, int period )
+{
+   app_class_construct( (AppClass *) rot );
+
+   rot->period = period > 0 ? period : ROTATION_PERIOD;
+}
+
+/** \brief Destructor for the VfddRotation object. */
+
+void rotation_destroy(void *rot)
+{
+   VfddRotation *this = (VfddRotation *) rot;
+   int i;
+
+   if (rot == NULL) {
+      return;
+   }
+   msg_dbg( "rotation %lu updates", this->updates );
+   for ( i = 0 ; i < this->func_num ; i++ ){
+      display_destroy( this->funcs[i] );
+   }
+   app_free(this->funcs);
+
+   app_class_destroy( rot );
+}
+
+void rotation_add( VfddRotation *rot, VfddDisplay *dis )
+{
+   rot->funcs = app_renew( VfddDisplay *, rot->funcs, rot->func_num + 1 );
+   rot->funcs[rot->func_num++] = dis;
+   /* the slots are looked at again */
+   rot->due = 0;
+}
+
+/*
+ * return the local secs of t in the period
+ */
+int rotation_phase( VfddRotation *rot, time_t t, long gmtoff )
+{
+   return ( ( t + gmtoff ) % rot->period + rot->period ) % rot->period;
+}
+
+/*
+ * return the function shown at phase : the highest priority, the first
+ * configured of equal ones, NULL if no slot holds phase
+ */
+VfddDisplay *rotation_pick( VfddRotation *rot, int phase )
+{
+   VfddDisplay *best = NULL;
+   int i;
+
+   for ( i = 0 ; i < rot->func_num ; i++ ){
+      VfddDisplay *dis = rot->funcs[i];
+      if ( display_shown( dis, phase, rot->period ) &&
+	   ( ! best || dis->priority > best->priority ) ){
+	 best = dis;
+      }
+   }
+   return best;
+}
+
+/*
+ * return the next time the string may change after t : the first slot
+ * edge showing another function or the refresh of the one shown
+ */
+time_t rotation_next_change( VfddRotation *rot, time_t t, long gmtoff )
+{
+   int phase = rotation_phase( rot, t, gmtoff );
+   VfddDisplay *shown = rotation_pick( rot, phase );
+   time_t next = t + rot->period;
+   int i, j;
+
+   if ( shown ){
+      next = display_next_refresh( shown, t, gmtoff );
+   }
+   for ( i = 0 ; i < rot->func_num ; i++ ){
+      VfddDisplay *dis = rot->funcs[i];
+      int edges[2] = { dis->start, dis->start + dis->duration };
+
+      if ( dis->duration >= rot->period ){
+	 continue;
+      }
+      for ( j = 0 ; j < 2 ; j++ ){
+	 int d = ( ( edges[j] - phase ) % rot->period + rot->period ) % rot->period;
+	 if ( d == 0 ){
+	    d = rot->period;
+	 }
+	 if ( t + d < next &&
+	      rotation_pick( rot, ( phase + d ) % rot->period ) != shown ){
+	    next = t + d;
+	 }
+      }
+   }
+   return next;
+}
+
+/*
+ * format the function shown at t if it may have changed,
+ * return 1 if it was formatted
+ */
+int rotation_update( VfddRotation *rot, time_t t, long gmtoff )
+{
+   /* a clock set back is a change */
+   if ( t < rot->due && t >= rot->last ){
+      return 0;
+   }
+   rot->shown = rotation_pick( rot, rotation_phase( rot, t, gmtoff ) );
+   if ( rot->shown ){
+      display_update( rot->shown );
+      rot->updates++;
+   }
+   rot->last = t;
+   rot->due = rotation_next_change( rot, t, gmtoff );
+   return 1;
+}
@@ -0,0 +1,43 @@
+#ifndef ROTATION_H
+#define ROTATION_H
+
+/*
+ * rotation.h - display functions shown in turn, each one in its
+ *              slot of a period, updated when it may change
+ *
+ * include LICENSE
+ */
+
+#include <time.h>
+
+#include <appclass.h>
+#include <display.h>
+
+#define ROTATION_PERIOD 60      /* default period of the slots, secs */
+
+typedef struct _VfddRotation VfddRotation;
+
+struct _VfddRotation {
+   AppClass parent;
+   VfddDisplay **funcs;         /* the display functions, in config order */
+   int func_num;
+   int period;                  /* secs between two runs of the slots */
+   VfddDisplay *shown;          /* function shown, NULL if none */
+   time_t last;                 /* time of the last update */
+   time_t due;                  /* next time shown or its value may change */
+   unsigned long updates;       /* function values formatted */
+};
+
+/*
+ * prototypes
+ */
+VfddRotation *rotation_new( int period );
+void rotation_construct( VfddRotation *rot, int period );
+void rotation_destroy(void *rot);
+
+void rotation_add( VfddRotation *rot, VfddDisplay *dis );
+VfddDisplay *rotation_pick( VfddRotation *rot, int phase );
+time_t rotation_next_change( VfddRotation *rot, time_t t, long gmtoff );
+int rotation_update( VfddRotation *rot, time_t t, long gmtoff );
+
+#endif /* ROTATION_H */
@@ -21,6 +21,7 @@
  * local prototypes
  */
 int loop_iter_channel_func( AppClass *channel, void *user_data );
+int loop_iter_timer_when( AppClass *data, void *user_data );
 
 /*
  *** \brief Allocates memory for a new Loop object.
@@ -148,6 +149,20 @@ int loop_iter_channel_func( AppClass *channel, void *user_data )
    return ret;  /* return 0 to avoid deleting the channel node */
 }
 
+/*
+ * keep the earliest timer time in user_data
+ */
+int loop_iter_timer_when( AppClass *data, void *user_data )
+{
+   Timer *timer = (Timer *) data;
+   struct timeval *when = (struct timeval *) user_data;
+
+   if ( ! timerisset( when ) || timercmp( &timer->when, when, < ) ){
+      *when = timer->when;
+   }
+   return 0;
+}
+
 void loop_quit(Loop *loop )
 {
    loop->endRequest = 1;
@@ -161,6 +176,7 @@ void loop_run(Loop *loop )
    struct timeval sel_timeout ;
    struct timeval run_timers ;
    struct timeval time_now ;
+   struct timeval next_timer ;
 
    timerclear(&run_timers);
    
@@ -171,6 +187,22 @@ void loop_run(Loop *loop )
 
       sel_timeout.tv_sec = loop->loop_timeout.tv_sec;
       sel_timeout.tv_usec = loop->loop_timeout.tv_usec ;
+
+      /* wake up on time for the earliest timer */
+      timerclear(&next_timer);
+      dlist_iterator( loop->timers, loop_iter_timer_when, &next_timer );
+      if ( timerisset( &next_timer ) ){
+         struct timeval wait;
+         gettimeofday(&time_now, NULL );
+         if ( timercmp(&next_timer, &time_now, <= ) ){
+            timerclear(&sel_timeout);
+         } else {
+            timersub(&next_timer, &time_now, &wait);
+            if ( timercmp(&wait, &sel_timeout, < ) ){
+               sel_timeout = wait;
+            }
+         }
+      }
       
       j = select(loop->width, &loop->fdscopy, NULL, NULL, &sel_timeout );
 
@@ -181,7 +213,8 @@ void loop_run(Loop *loop )
          }
          /* j == 0 , timeout */
          gettimeofday(&time_now, NULL );
-         if ( timercmp(&time_now, &run_timers, >= ) ){
+         if ( timercmp(&time_now, &run_timers, >= ) ||
+              ( timerisset( &next_timer ) && timercmp(&time_now, &next_timer, >= ) ) ){
              do_timers = 1;
          }
       }
@@ -0,0 +1,327 @@
+/*
+ * sensors.c - temperature sensors found by name.
+ *
+ *   A function names its sensor by hwmon name ("cpu_thermal"),
+ *   hwmon name and label ("coretemp/Package id 0"), label alone or
+ *   thermal zone type ("soc-thermal"), the number of the hwmon or
+ *   thermal_zone dir may change between kernels and boots.
+ *
+ *   The index of the sensors is read from a state file. /sys is
+ *   scanned, and the state file written, only when a key is not in
+ *   the index or its dir no longer holds the same sensor.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <sensors.h>
+#include <strmem.h>
+#include <duprintf.h>
+
+/*
+ * local prototypes
+ */
+int sensors_read_line( const char *path, char *buf, int size );
+void sensors_add( VfddSensors *sn, const char *key, const char *ident, const char *path );
+void sensors_clear( VfddSensors *sn );
+void sensors_load( VfddSensors *sn );
+void sensors_save( VfddSensors *sn );
+void sensors_scan_hwmon( VfddSensors *sn, const char *dir );
+void sensors_scan( VfddSensors *sn );
+SensorEntry *sensors_lookup( VfddSensors *sn, const char *key );
+int sensors_check( SensorEntry *e );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddSensors object.
+ *  state_dir : dir of the index file, NULL not to keep it
+ */
+
+VfddSensors *sensors_new( const char *state_dir )
+{
+   VfddSensors *sn;
+
+   sn =  app_new0(VfddSensors, 1);
+   sensors_construct( sn, state_dir );
+   app_class_overload_destroy( (AppClass *) sn, sensors_destroy );
+   return sn;
+}
+
+/** \brief Constructor for the VfddSensors object. */
+
+void sensors_construct( VfddSensors *sn, const char *state_dir )
+{
+   app_class_construct( (AppClass *) sn );
+
+   if ( state_dir ){
+      sn->cache = app_strdup_printf( "%s/%s", state_dir, SENSORS_CACHE );
+      sensors_load( sn );
+   }
+}
+
+/** \brief Destructor for the VfddSensors object. */
+
+void sensors_destroy(void *sn)
+{
+   VfddSensors *this = (VfddSensors *) sn;
+
+   if (sn == NULL) {
+      return;
+   }
+   sensors_clear( this );
+   app_free(this->cache);
+
+   app_class_destroy( sn );
+}
+
+/*
+ * read the first line of a small file, without its newline
+ */
+int sensors_read_line( const char *path, char *buf, int size )
+{
+   FILE *fp = fopen( path, "r" );
+
+   buf[0] = 0;
+   if ( ! fp ){
+      return -1;
+   }
+   if ( ! fgets( buf, size, fp ) ){
+      buf[0] = 0;
+   }
+   fclose( fp );
+   buf[strcspn( buf, "\n" )] = 0;
+   return strlen( buf );
+}
+
+void sensors_add( VfddSensors *sn, const char *key, const char *ident, const char *path )
+{
+   SensorEntry *e;
+
+   sn->entries = app_renew( SensorEntry, sn->entries, sn->entry_num + 1 );
+   e = &sn->entries[sn->entry_num++];
+   e->key = app_strdup( key );
+   e->ident = app_strdup( ident );
+   e->path = app_strdup( path );
+}
+
+void sensors_clear( VfddSensors *sn )
+{
+   int i;
+
+   for ( i = 0 ; i < sn->entry_num ; i++ ){
+      app_free( sn->entries[i].key );
+      app_free( sn->entries[i].ident );
+      app_free( sn->entries[i].path );
+   }
+   app_free( sn->entries );
+   sn->entries = NULL;
+   sn->entry_num = 0;
+}
+
+/*
+ * one sensor per line : path <tab> ident <tab> key
+ * the key last, a label may hold spaces
+ */
+void sensors_load( VfddSensors *sn )
+{
+   char line[SENSORS_LINE_SIZ * 2];
+   FILE *fp = fopen( sn->cache, "r" );
+
+   if ( ! fp ){
+      return;
+   }
+   while ( fgets( line, sizeof(line), fp ) ){
+      char *path = line;
+      char *ident, *key;
+
+      line[strcspn( line, "\n" )] = 0;
+      ident = strchr( path, '\t' );
+      if ( ! ident ){
+	 continue;
+      }
+      *ident++ = 0;
+      key = strchr( ident, '\t' );
+      if ( ! key ){
+	 continue;
+      }
+      *key++ = 0;
+      sensors_add( sn, key, ident, path );
+   }
+   fclose( fp );
+   msg_dbg( "%d sensors from '%s'", sn->entry_num, sn->cache );
+}
+
+void sensors_save( VfddSensors *sn )
+{
+   char *tmp;
+   FILE *fp;
+   int i;
+
+   if ( ! sn->cache ){
+      return;
+   }
+   /* a crash while writing leaves the old index */
+   tmp = app_strdup_printf( "%s.tmp", sn->cache );
+   fp = fopen( tmp, "w" );
+   if ( ! fp ){
+      msg_error( "Failed to open file '%s' - %s", tmp, strerror(errno) );
+      app_free(tmp);
+      return;
+   }
+   for ( i = 0 ; i < sn->entry_num ; i++ ){
+      SensorEntry *e = &sn->entries[i];
+      fprintf( fp, "%s\t%s\t%s\n", e->path, e->ident, e->key );
+   }
+   if ( fclose( fp ) || rename( tmp, sn->cache ) < 0 ){
+      msg_error( "Failed to write file '%s' - %s", sn->cache, strerror(errno) );
+   }
+   app_free(tmp);
+}
+
+/*
+ * the temp inputs of a hwmon dir : the first one under the hwmon
+ * name, each one under its label, alone and after the name
+ */
+void sensors_scan_hwmon( VfddSensors *sn, const char *dir )
+{
+   char name[SENSORS_LINE_SIZ];
+   char label[SENSORS_LINE_SIZ];
+   char *path;
+   int first = 1;
+   int i;
+
+   path = app_strdup_printf( "%s/name", dir );
+   sensors_read_line( path, name, sizeof(name) );
+   app_free(path);
+   if ( ! name[0] ){
+      return;
+   }
+   /* the inputs are numbered from 1, a few may be missing */
+   for ( i = 1 ; i < 32 ; i++ ){
+      path = app_strdup_printf( "%s/temp%d_input", dir, i );
+      if ( access( path, R_OK ) < 0 ){
+	 app_free(path);
+	 continue;
+      }
+      if ( first ){
+	 sensors_add( sn, name, name, path );
+	 first = 0;
+      }
+      char *lpath = app_strdup_printf( "%s/temp%d_label", dir, i );
+      if ( sensors_read_line( lpath, label, sizeof(label) ) > 0 ){
+	 char *key = app_strdup_printf( "%s/%s", name, label );
+	 sensors_add( sn, key, name, path );
+	 sensors_add( sn, label, name, path );
+	 app_free(key);
+      }
+      app_free(lpath);
+      app_free(path);
+   }
+}
+
+/*
+ * build the index from /sys/class/hwmon and /sys/class/thermal
+ */
+void sensors_scan( VfddSensors *sn )
+{
+   char type[SENSORS_LINE_SIZ];
+   struct dirent *de;
+   DIR *d;
+
+   sensors_clear( sn );
+   sn->scanned = 1;
+
+   d = opendir( SENSORS_CLASS_DIR "/hwmon" );
+   while ( d && ( de = readdir( d ) ) ){
+      if ( strncmp( de->d_name, "hwmon", 5 ) == 0 ){
+	 char *dir = app_strdup_printf( "%s/hwmon/%s", SENSORS_CLASS_DIR, de->d_name );
+	 sensors_scan_hwmon( sn, dir );
+	 app_free(dir);
+      }
+   }
+   if ( d ){
+      closedir( d );
+   }
+   d = opendir( SENSORS_CLASS_DIR "/thermal" );
+   while ( d && ( de = readdir( d ) ) ){
+      if ( strncmp( de->d_name, "thermal_zone", 12 ) == 0 ){
+	 char *path = app_strdup_printf( "%s/thermal/%s/type", SENSORS_CLASS_DIR, de->d_name );
+	 if ( sensors_read_line( path, type, sizeof(type) ) > 0 ){
+	    app_free(path);
+	    path = app_strdup_printf( "%s/thermal/%s/temp", SENSORS_CLASS_DIR, de->d_name );
+	    sensors_add( sn, type, type, path );
+	 }
+	 app_free(path);
+      }
+   }
+   if ( d ){
+      closedir( d );
+   }
+   msg_info( "%d sensors found in %s", sn->entry_num, SENSORS_CLASS_DIR );
+   sensors_save( sn );
+}
+
+SensorEntry *sensors_lookup( VfddSensors *sn, const char *key )
+{
+   int i;
+
+   for ( i = 0 ; i < sn->entry_num ; i++ ){
+      if ( strcmp( sn->entries[i].key, key ) == 0 ){
+	 return &sn->entries[i];
+      }
+   }
+   return NULL;
+}
+
+/*
+ * return 1 if the dir of the entry still holds its sensor :
+ * the hwmon name or the thermal type is the same
+ */
+int sensors_check( SensorEntry *e )
+{
+   char buf[SENSORS_LINE_SIZ];
+   const char *files[] = { "name", "type" };
+   char *slash = strrchr( e->path, '/' );
+   int i;
+
+   if ( ! slash || access( e->path, R_OK ) < 0 ){
+      return 0;
+   }
+   for ( i = 0 ; i < 2 ; i++ ){
+      char *path = app_strdup_printf( "%.*s/%s", (int) ( slash - e->path ),
+				      e->path, files[i] );
+      int len = sensors_read_line( path, buf, sizeof(buf) );
+      app_free(path);
+      if ( len >= 0 ){
+	 return strcmp( buf, e->ident ) == 0;
+      }
+   }
+   return 0;
+}
+
+/*
+ * return the temperature file of the sensor named key, NULL if none,
+ * valid until the next call
+ */
+const char *sensors_resolve( VfddSensors *sn, const char *key )
+{
+   SensorEntry *e = sensors_lookup( sn, key );
+
+   if ( e && ( sn->scanned || sensors_check( e ) ) ){
+      return e->path;
+   }
+   if ( ! sn->scanned ){
+      sensors_scan( sn );
+      e = sensors_lookup( sn, key );
+   }
+   if ( ! e ){
+      msg_error( "sensor '%s' not found", key );
+      return NULL;
+   }
+   msg_dbg( "sensor '%s' is '%s'", key, e->path );
+   return e->path;
+}
@@ -0,0 +1,46 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+/*
+ * sensors.h - temperature sensors found by name in hwmon and
+ *             thermal, the index cached in a state file
+ *
+ * include LICENSE
+ */
+
+#include <appclass.h>
+
+#ifndef SENSORS_CLASS_DIR
+#define SENSORS_CLASS_DIR "/sys/class"
+#endif
+#define SENSORS_CACHE "sensors"         /* index file in the state dir */
+#define SENSORS_LINE_SIZ 256
+
+typedef struct _SensorEntry SensorEntry;
+
+struct _SensorEntry {
+   char *key;                   /* "name", "name/label", "label" or thermal type */
+   char *ident;                 /* hwmon name or thermal type of the sensor dir */
+   char *path;                  /* its temperature file */
+};
+
+typedef struct _VfddSensors VfddSensors;
+
+struct _VfddSensors {
+   AppClass parent;
+   char *cache;                 /* state file of the index, NULL if none */
+   SensorEntry *entries;        /* the index, from the cache or a scan */
+   int entry_num;
+   int scanned;                 /* 1 once /sys was scanned by this run */
+};
+
+/*
+ * prototypes
+ */
+VfddSensors *sensors_new( const char *state_dir );
+void sensors_construct( VfddSensors *sn, const char *state_dir );
+void sensors_destroy(void *sn);
+
+const char *sensors_resolve( VfddSensors *sn, const char *key );
+
+#endif /* SENSORS_H */
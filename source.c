@@ -0,0 +1,378 @@
+/*
+ * source.c - data files shared by every panel, display function
+ *            and dotled that uses them.
+ *
+ *   A file is read at most once per frame for all its users, or
+ *   once per freshness window of a user showing it on demand.
+ *   Otherwise it is read when its poll is due. The poll interval doubles
+ *   while the file gives the same bytes, up to max_ms, and is back
+ *   to min_ms when they change. The users compare the hash of the
+ *   bytes with the one they parsed last.
+ *
+ *   A missing file is polled less and less often too, up to once a
+ *   minute, and only its comings and goings are logged.
+ *
+ *   The number a read starts with is kept in a ring of the last
+ *   SOURCE_HISTORY samples, with a running sum for the average.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <source.h>
+#include <jsonroot.h>
+
+/*
+ * local prototypes
+ */
+uint32_t source_hash( const char *buf, int len );
+void source_set_state( VfddSource *src, int state, int err );
+void source_update( VfddSource *src, const struct timeval *now );
+void source_history_push( VfddSource *src, const struct timeval *now );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddSource object.
+ */
+
+VfddSource *source_new( char *path )
+{
+   VfddSource *src;
+
+   src =  app_new0(VfddSource, 1);
+   source_construct( src, path );
+   app_class_overload_destroy( (AppClass *) src, source_destroy );
+   return src;
+}
+
+/** \brief Constructor for the VfddSource object. */
+
+void source_construct( VfddSource *src, char *path )
+{
+   app_class_construct( (AppClass *) src );
+   src->path = app_strdup(path);
+   src->size = SOURCE_BUF_SIZ;
+   src->buf = app_new0(char, src->size);
+   src->len = -1;
+}
+
+/** \brief Destructor for the VfddSource object. */
+
+void source_destroy(void *src)
+{
+   VfddSource *this = (VfddSource *) src;
+
+   if (src == NULL) {
+      return;
+   }
+   msg_dbg( "source '%s' %d users : %lu reads %lu unchanged %lu shared %lu saved %lu failed, interval %d ms",
+	    this->path, this->users, this->reads, this->unchanged, this->shared,
+	    this->saved, this->failures, this->interval );
+   app_free(this->path);
+   app_free(this->buf);
+
+   app_class_destroy( src );
+}
+
+int source_path_str_cmp(AppClass *d1, AppClass *d2 )
+{
+   VfddSource *src = (VfddSource *) d1 ;
+   char *path = (char *) d2 ;
+   return app_strcmp( src->path, path );
+}
+
+/*
+ * log a change of state, at most once per SOURCE_LOG_SEC : the
+ * changes in between are logged with the next one
+ */
+void source_set_state( VfddSource *src, int state, int err )
+{
+   time_t now;
+
+   if ( state != src->state ){
+      src->state = state;
+      src->unlogged++;
+   }
+   if ( ! src->unlogged || ( now = time( NULL ) ) < src->log_next ){
+      return;
+   }
+   src->log_next = now + SOURCE_LOG_SEC;
+   switch ( state ){
+    case SOURCE_OK:
+      msg_info( "'%s' is readable", src->path );
+      break;
+    case SOURCE_ABSENT:
+      msg_info( "'%s' is missing - %s", src->path, strerror(err) );
+      break;
+    default:
+      msg_error( "Failed to read file '%s' - %s", src->path, strerror(err) );
+      break;
+   }
+   if ( src->unlogged > 1 ){
+      msg_dbg( "'%s' changed %lu times since the last message", src->path,
+	       src->unlogged );
+   }
+   src->unlogged = 0;
+}
+
+/*
+ * read the file, return the length read or -1
+ */
+int source_read( VfddSource *src )
+{
+   int state = SOURCE_OK;
+   int err = 0;
+
+   src->len = -1;
+   src->buf[0] = 0;
+
+   int fd = open( src->path, O_RDONLY );
+   if ( fd < 0 ){
+      err = errno;
+      state = ( err == ENOENT || err == ENOTDIR || err == ENODEV || err == ENXIO ) ?
+	 SOURCE_ABSENT : SOURCE_ERROR;
+   } else {
+      ssize_t n = read( fd, src->buf, src->size - 1 );
+      if ( n < 0 ){
+	 err = errno;
+	 state = SOURCE_ERROR;
+      } else {
+	 src->len = n;
+	 src->buf[n] = 0;
+      }
+      close( fd );
+   }
+   if ( state != SOURCE_OK ){
+      src->failures++;
+   }
+   source_set_state( src, state, err );
+   return src->len;
+}
+
+/*
+ * return the source for path, shared with the other users
+ */
+VfddSource *source_get( Vfdd *vf, char *path )
+{
+   VfddSource *src = (VfddSource *) dlist_lookup( vf->sources, (AppClass *) path,
+						  source_path_str_cmp );
+   if ( ! src ){
+      src = source_new( path );
+      vf->sources = dlist_add_tail(vf->sources, (AppClass *) src );
+   }
+   src->users++;
+   return src;
+}
+
+/*
+ * make room for size - 1 bytes of a file, a larger one is truncated
+ */
+void source_set_size( VfddSource *src, int size )
+{
+   if ( size <= src->size ){
+      return;
+   }
+   src->buf = app_renew(char, src->buf, size );
+   src->size = size;
+   src->len = -1;
+   src->buf[0] = 0;
+}
+
+/*
+ * "poll_min_ms", "poll_max_ms" : interval bounds of a user,
+ * a shared file is polled as fast as its fastest user needs
+ */
+void source_conf_bounds( VfddSource *src, JsonNode *node )
+{
+   int val;
+
+   if ( ! json_root_get_item_int( node, "poll_min_ms", &val ) || val <= 0 ){
+      val = SOURCE_MIN_MS;
+   }
+   if ( ! src->min_ms || val < src->min_ms ){
+      src->min_ms = val;
+   }
+   if ( ! json_root_get_item_int( node, "poll_max_ms", &val ) || val <= 0 ){
+      val = SOURCE_MAX_MS;
+   }
+   if ( ! src->max_ms || val < src->max_ms ){
+      src->max_ms = val;
+   }
+}
+
+/*
+ * FNV-1a, never 0 which marks a file not read
+ */
+uint32_t source_hash( const char *buf, int len )
+{
+   uint32_t h = 2166136261u;
+   int i;
+
+   for ( i = 0 ; i < len ; i++ ){
+      h ^= (uint8_t) buf[i];
+      h *= 16777619u;
+   }
+   return h ? h : 1;
+}
+
+/*
+ * read the file at now and set its next poll
+ */
+void source_update( VfddSource *src, const struct timeval *now )
+{
+   uint32_t hash;
+
+   if ( ! src->min_ms ){
+      src->min_ms = SOURCE_MIN_MS;
+      src->max_ms = SOURCE_MAX_MS;
+   }
+   source_read( src );
+   src->reads++;
+   src->read_at = *now;
+   hash = src->len < 0 ? 0 : source_hash( src->buf, src->len );
+   source_history_push( src, now );
+   if ( hash != src->hash || src->reads == 1 ){
+      src->hash = hash;
+      src->interval = src->min_ms;
+   } else {
+      /* a missing file backs off further */
+      int max_ms = src->len < 0 ? SOURCE_ABSENT_MS : src->max_ms;
+      src->unchanged++;
+      src->interval *= 2;
+      if ( src->interval > max_ms ){
+	 src->interval = max_ms > src->min_ms ? max_ms : src->min_ms;
+      }
+   }
+   struct timeval interval = { src->interval / 1000, (src->interval % 1000) * 1000 };
+   timeradd( now, &interval, &src->next );
+}
+
+/*
+ * read the file if its poll is due at now, once for all the users
+ * of a frame, return 1 if it was read
+ */
+int source_poll( VfddSource *src, const struct timeval *now )
+{
+   if ( src->reads && timercmp( now, &src->read_at, == ) ){
+      src->shared++;
+      return 0;
+   }
+   if ( timercmp( now, &src->next, < ) ){
+      src->saved++;
+      return 0;
+   }
+   source_update( src, now );
+   return 1;
+}
+
+/*
+ * read the file unless it was read less than fresh_ms before now,
+ * return 1 if it was read
+ */
+int source_fresh( VfddSource *src, const struct timeval *now, int fresh_ms )
+{
+   struct timeval age;
+
+   if ( src->reads ){
+      timersub( now, &src->read_at, &age );
+      if ( age.tv_sec >= 0 && age.tv_sec * 1000L + age.tv_usec / 1000 <= fresh_ms ){
+	 src->shared++;
+	 return 0;
+      }
+   }
+   source_update( src, now );
+   return 1;
+}
+
+/*
+ * keep the number of a file holding one decimal number, the oldest
+ * sample of a full ring leaves it : a file of several fields (a disk
+ * stat) has no sample
+ */
+void source_history_push( VfddSource *src, const struct timeval *now )
+{
+   SourceSample *sa = &src->hist[src->hist_head];
+   char *end;
+   long val;
+
+   if ( src->len <= 0 ){
+      return;
+   }
+   /* base 10 : "010" is ten, not an octal eight */
+   val = strtol( src->buf, &end, 10 );
+   if ( end == src->buf || end[strspn( end, " \t\n" )] ){
+      return;
+   }
+   if ( src->hist_num == SOURCE_HISTORY ){
+      src->hist_sum -= sa->val;
+   } else {
+      src->hist_num++;
+   }
+   sa->at = *now;
+   sa->val = val;
+   src->hist_sum += val;
+   src->hist_head = ( src->hist_head + 1 ) % SOURCE_HISTORY;
+}
+
+/*
+ * fill st from the history, return the number of samples
+ */
+int source_stats( VfddSource *src, SourceStats *st )
+{
+   int i;
+
+   memset( st, 0, sizeof(*st) );
+   st->num = src->hist_num;
+   if ( ! st->num ){
+      return 0;
+   }
+   int first = ( src->hist_head - src->hist_num + SOURCE_HISTORY ) % SOURCE_HISTORY;
+   int last = ( src->hist_head - 1 + SOURCE_HISTORY ) % SOURCE_HISTORY;
+
+   st->last = src->hist[last].val;
+   st->min = st->max = st->last;
+   for ( i = 0 ; i < src->hist_num ; i++ ){
+      long val = src->hist[i].val;
+      if ( val < st->min ){
+	 st->min = val;
+      }
+      if ( val > st->max ){
+	 st->max = val;
+      }
+   }
+   st->avg = src->hist_sum / src->hist_num;
+   st->trend = ( st->last > st->avg ) - ( st->last < st->avg );
+
+   struct timeval span;
+   timersub( &src->hist[last].at, &src->hist[first].at, &span );
+   long ms = span.tv_sec * 1000L + span.tv_usec / 1000;
+   if ( ms > 0 ){
+      st->rate = ( st->last - src->hist[first].val ) * 60000LL / ms;
+   }
+   return st->num;
+}
+
+/*
+ * log the counters and the history of a source
+ */
+int source_iter_log_stats( AppClass *data, void *user_data )
+{
+   VfddSource *src = (VfddSource *) data;
+   SourceStats st;
+
+   msg_info( "source '%s' %d users : %lu reads %lu unchanged %lu shared %lu saved %lu failed, interval %d ms",
+	     src->path, src->users, src->reads, src->unchanged, src->shared,
+	     src->saved, src->failures, src->interval );
+   if ( source_stats( src, &st ) ){
+      msg_info( "source '%s' last %d : %ld min %ld avg %ld max %ld, %+ld per min, trend %c",
+		src->path, st.num, st.last, st.min, st.avg, st.max, st.rate,
+		"-=+"[st.trend + 1] );
+   }
+   return 0;
+}
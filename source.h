@@ -0,0 +1,96 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+/*
+ * source.h - data files shared by every panel, display function
+ *            and dotled that uses them, read once per frame when
+ *            their poll is due or their data are too old.
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <vfdd.h>
+#include <jsonnode.h>
+
+#define SOURCE_BUF_SIZ 256      /* default buffer size */
+#define SOURCE_MIN_MS  500      /* default poll interval after a change */
+#define SOURCE_MAX_MS  8000     /* default poll interval of a steady file */
+#define SOURCE_ABSENT_MS 60000  /* poll interval of a file missing for long */
+#define SOURCE_LOG_SEC 10       /* min secs between two state messages of a file */
+#define SOURCE_HISTORY 16       /* samples kept per file */
+
+enum _SourceState {
+   SOURCE_OK,                   /* the file is read */
+   SOURCE_ABSENT,               /* no such file or device */
+   SOURCE_ERROR,                /* the file cannot be read */
+};
+
+typedef struct _SourceSample SourceSample;
+
+struct _SourceSample {
+   struct timeval at;           /* time of the read */
+   long val;                    /* number at the start of the file */
+};
+
+typedef struct _SourceStats SourceStats;
+
+struct _SourceStats {
+   int num;                     /* samples in the history */
+   long last;
+   long min;
+   long max;
+   long avg;
+   long rate;                   /* change per minute from the oldest sample to the last */
+   int trend;                   /* -1, 0 or 1 : the last sample below, at or above avg */
+};
+
+typedef struct _VfddSource VfddSource;
+
+struct _VfddSource {
+   AppClass parent;
+   char *path;                  /* sysfs or proc file name */
+   char *buf;                   /* file content, null terminated */
+   int size;                    /* size of buf */
+   int len;                     /* length of data in buf, -1 if not read */
+   uint32_t hash;               /* hash of buf, 0 if not read */
+   int interval;                /* milisecs to the next read, doubled while buf is the same */
+   int min_ms;                  /* interval bounds */
+   int max_ms;
+   struct timeval next;         /* time of the next read */
+   struct timeval read_at;      /* time of the last read */
+   int users;                   /* dotleds and functions using it */
+   int state;                   /* SOURCE_xxx of the last read */
+   time_t log_next;             /* time a state change may be logged again */
+   unsigned long reads;         /* files read */
+   unsigned long unchanged;     /* reads giving the same buf */
+   unsigned long shared;        /* polls served by a read of the same frame or window */
+   unsigned long saved;         /* polls before the next read */
+   unsigned long failures;      /* reads of a missing or unreadable file */
+   unsigned long unlogged;      /* state changes not logged yet */
+   SourceSample hist[SOURCE_HISTORY];  /* ring of the last numeric reads */
+   int hist_head;               /* slot of the next sample */
+   int hist_num;                /* samples in the ring */
+   long long hist_sum;          /* sum of their values */
+};
+
+/*
+ * prototypes
+ */
+VfddSource *source_new( char *path );
+void source_construct( VfddSource *src, char *path );
+void source_destroy(void *src);
+
+int source_path_str_cmp(AppClass *d1, AppClass *d2 );
+int source_read( VfddSource *src );
+VfddSource *source_get( Vfdd *vf, char *path );
+void source_set_size( VfddSource *src, int size );
+void source_conf_bounds( VfddSource *src, JsonNode *node );
+int source_poll( VfddSource *src, const struct timeval *now );
+int source_fresh( VfddSource *src, const struct timeval *now, int fresh_ms );
+int source_stats( VfddSource *src, SourceStats *st );
+int source_iter_log_stats( AppClass *data, void *user_data );
+
+#endif /* SOURCE_H */
@@ -0,0 +1,294 @@
+/*
+ * sysstat.c - cpu load, available memory and network throughput.
+ *
+ *   The /proc files are opened once and read again from their start
+ *   with pread into buffers of the object, at most once per freshness
+ *   window of the functions showing them. The counters of the previous
+ *   read are kept, the load and the rates are their deltas : nothing
+ *   is allocated after start.
+ *
+ * include LICENSE
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sysstat.h>
+#include <strmem.h>
+
+typedef struct _SysStatPath SysStatPath;
+
+struct _SysStatPath {
+   const char *path;
+   int size;                    /* bytes needed from the start of the file */
+};
+
+static const SysStatPath sysstat_paths[SYSSTAT_FILES] = {
+   { "/proc/stat", 256 },       /* the cpu line */
+   { "/proc/meminfo", 256 },    /* MemTotal, MemFree, MemAvailable */
+   { "/proc/net/dev", SYSSTAT_BUF_SIZ },
+};
+
+/*
+ * local prototypes
+ */
+int sysstat_read( VfddSysStat *ss, int file );
+void sysstat_parse_cpu( VfddSysStat *ss, char *p );
+void sysstat_parse_mem( VfddSysStat *ss, char *p );
+void sysstat_parse_net( VfddSysStat *ss, char *p, long ms );
+/* */
+
+/*
+ *** \brief Allocates memory for a new VfddSysStat object.
+ */
+
+VfddSysStat *sysstat_new( void )
+{
+   VfddSysStat *ss;
+
+   ss =  app_new0(VfddSysStat, 1);
+   sysstat_construct( ss );
+   app_class_overload_destroy( (AppClass *) ss, sysstat_destroy );
+   return ss;
+}
+
+/** \brief Constructor for the VfddSysStat object. */
+
+void sysstat_construct( VfddSysStat *ss )
+{
+   int i;
+
+   app_class_construct( (AppClass *) ss );
+
+   for ( i = 0 ; i < SYSSTAT_FILES ; i++ ){
+      ss->files[i].len = -1;
+      ss->files[i].fd = open( sysstat_paths[i].path, O_RDONLY );
+      if ( ss->files[i].fd < 0 ){
+	 msg_error( "Failed to open file '%s' - %s", sysstat_paths[i].path,
+		    strerror(errno) );
+      }
+   }
+}
+
+/** \brief Destructor for the VfddSysStat object. */
+
+void sysstat_destroy(void *ss)
+{
+   VfddSysStat *this = (VfddSysStat *) ss;
+   int i;
+
+   if (ss == NULL) {
+      return;
+   }
+   for ( i = 0 ; i < SYSSTAT_FILES ; i++ ){
+      msg_dbg( "sysstat '%s' : %lu reads %lu shared", sysstat_paths[i].path,
+	       this->files[i].reads, this->files[i].shared );
+      if ( this->files[i].fd >= 0 ){
+	 close( this->files[i].fd );
+      }
+   }
+
+   app_class_destroy( ss );
+}
+
+/*
+ * watch the interface name, return its index or -1
+ */
+int sysstat_add_iface( VfddSysStat *ss, const char *name )
+{
+   int i;
+
+   for ( i = 0 ; i < ss->iface_num ; i++ ){
+      if ( strcmp( ss->ifaces[i].name, name ) == 0 ){
+	 return i;
+      }
+   }
+   if ( ss->iface_num >= SYSSTAT_MAX_IFACES || strlen(name) >= SYSSTAT_NAME_SIZ ){
+      msg_error( "sysstat : cannot watch interface '%s'", name );
+      return -1;
+   }
+   strcpy( ss->ifaces[ss->iface_num].name, name );
+   return ss->iface_num++;
+}
+
+/*
+ * read the file again from its start, return the length read or -1
+ */
+int sysstat_read( VfddSysStat *ss, int file )
+{
+   SysStatFile *sf = &ss->files[file];
+   ssize_t n;
+
+   sf->len = -1;
+   sf->buf[0] = 0;
+   if ( sf->fd < 0 ){
+      return -1;
+   }
+   n = pread( sf->fd, sf->buf, sysstat_paths[file].size - 1, 0 );
+   if ( n < 0 ){
+      msg_error( "Failed to read file '%s' - %s", sysstat_paths[file].path,
+		 strerror(errno) );
+      return -1;
+   }
+   sf->buf[n] = 0;
+   sf->len = n;
+   sf->reads++;
+   return n;
+}
+
+/*
+ * cpu  user nice system idle iowait irq softirq steal ...
+ */
+void sysstat_parse_cpu( VfddSysStat *ss, char *p )
+{
+   uint64_t f[8];
+   uint64_t total = 0;
+   int i;
+
+   if ( strncmp( p, "cpu ", 4 ) != 0 ){
+      return;
+   }
+   p += 4;
+   for ( i = 0 ; i < 8 ; i++ ){
+      f[i] = strtoull( p, &p, 10 );
+      total += f[i];
+   }
+   uint64_t idle = f[3] + f[4];
+   if ( ss->cpu_total && total > ss->cpu_total && idle >= ss->cpu_idle ){
+      uint64_t dt = total - ss->cpu_total;
+      uint64_t di = idle - ss->cpu_idle;
+      ss->cpu_load = di < dt ? ( ( dt - di ) * 100 + dt / 2 ) / dt : 0;
+   }
+   ss->cpu_total = total;
+   ss->cpu_idle = idle;
+}
+
+/*
+ * MemAvailable:    1234567 kB
+ */
+void sysstat_parse_mem( VfddSysStat *ss, char *p )
+{
+   p = strstr( p, "MemAvailable:" );
+   if ( p ){
+      ss->mem_avail = strtoul( p + 13, NULL, 10 ) / 1024;
+   }
+}
+
+/*
+ *   eth0: rbytes rpackets errs drop fifo frame compressed multicast tbytes ...
+ * ms : milisecs since the previous read, 0 for the first one
+ */
+void sysstat_parse_net( VfddSysStat *ss, char *p, long ms )
+{
+   int was[SYSSTAT_MAX_IFACES];
+   int i, j;
+
+   for ( i = 0 ; i < ss->iface_num ; i++ ){
+      was[i] = ss->ifaces[i].seen;
+      ss->ifaces[i].seen = 0;
+   }
+   while ( *p ){
+      char *eol = strchr( p, '\n' );
+      char *name, *colon;
+
+      if ( ! eol ){
+	 eol = p + strlen(p);
+      }
+      name = p + strspn( p, " " );
+      colon = memchr( name, ':', eol - name );
+      for ( i = 0 ; colon && i < ss->iface_num ; i++ ){
+	 SysStatIface *ifa = &ss->ifaces[i];
+	 size_t len = colon - name;
+	 char *end = colon + 1;
+	 uint64_t rx, tx;
+
+	 if ( strncmp( ifa->name, name, len ) != 0 || ifa->name[len] ){
+	    continue;
+	 }
+	 rx = strtoull( end, &end, 10 );
+	 for ( j = 0 ; j < 8 ; j++ ){
+	    tx = strtoull( end, &end, 10 );
+	 }
+	 /* an interface back or a counter going back has no rate yet */
+	 if ( ms > 0 && was[i] && rx + tx >= ifa->bytes ){
+	    ifa->rate = ( rx + tx - ifa->bytes ) * 8 * 1000 / ms;
+	 } else {
+	    ifa->rate = 0;
+	 }
+	 ifa->bytes = rx + tx;
+	 ifa->seen = 1;
+	 break;
+      }
+      p = *eol ? eol + 1 : eol;
+   }
+   for ( i = 0 ; i < ss->iface_num ; i++ ){
+      if ( ! ss->ifaces[i].seen ){
+	 ss->ifaces[i].rate = 0;
+      }
+   }
+}
+
+/*
+ * read file unless it was read less than fresh_ms before now, once
+ * for all the functions and panels, and parse the new read
+ */
+void sysstat_update( VfddSysStat *ss, int file, const struct timeval *now, int fresh_ms )
+{
+   SysStatFile *sf = &ss->files[file];
+   struct timeval age;
+   long ms = 0;
+
+   if ( sf->reads ){
+      timersub( now, &sf->read_at, &age );
+      ms = age.tv_sec * 1000L + age.tv_usec / 1000;
+      if ( age.tv_sec >= 0 && ms <= fresh_ms ){
+	 sf->shared++;
+	 return;
+      }
+   }
+   if ( sysstat_read( ss, file ) < 0 ){
+      return;
+   }
+   sf->read_at = *now;
+   switch ( file ){
+    case SYSSTAT_CPU:
+      sysstat_parse_cpu( ss, sf->buf );
+      break;
+    case SYSSTAT_MEM:
+      sysstat_parse_mem( ss, sf->buf );
+      break;
+    case SYSSTAT_NET:
+      sysstat_parse_net( ss, sf->buf, ms );
+      break;
+   }
+}
+
+/*
+ * busy percent of all the cpus
+ */
+int sysstat_cpu_load( VfddSysStat *ss )
+{
+   return ss->cpu_load;
+}
+
+/*
+ * available memory, MiB
+ */
+int sysstat_mem_avail( VfddSysStat *ss )
+{
+   return ss->mem_avail;
+}
+
+/*
+ * bits per sec received and sent by interface idx
+ */
+unsigned long sysstat_net_rate( VfddSysStat *ss, int idx )
+{
+   if ( idx < 0 || idx >= ss->iface_num ){
+      return 0;
+   }
+   return ss->ifaces[idx].rate;
+}
@@ -0,0 +1,73 @@
+#ifndef SYSSTAT_H
+#define SYSSTAT_H
+
+/*
+ * sysstat.h - cpu load, available memory and network throughput
+ *             from /proc files kept open and read again in place
+ *
+ * include LICENSE
+ */
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <appclass.h>
+
+#define SYSSTAT_BUF_SIZ   4096      /* room for the lines of many interfaces */
+#define SYSSTAT_MAX_IFACES 4        /* max interfaces watched */
+#define SYSSTAT_NAME_SIZ  16        /* IFNAMSIZ */
+
+enum _SysStatKind {
+   SYSSTAT_CPU,                 /* /proc/stat */
+   SYSSTAT_MEM,                 /* /proc/meminfo */
+   SYSSTAT_NET,                 /* /proc/net/dev */
+   SYSSTAT_FILES,
+};
+
+typedef struct _SysStatFile SysStatFile;
+
+struct _SysStatFile {
+   int fd;                      /* open from start to end, -1 if it failed */
+   int len;                     /* length of data in buf, -1 if not read */
+   struct timeval read_at;      /* time of the last read */
+   unsigned long reads;
+   unsigned long shared;        /* updates served by a read fresh enough */
+   char buf[SYSSTAT_BUF_SIZ];
+};
+
+typedef struct _SysStatIface SysStatIface;
+
+struct _SysStatIface {
+   char name[SYSSTAT_NAME_SIZ]; /* ex "eth0", "wlan0" */
+   uint64_t bytes;              /* bytes received and sent */
+   unsigned long rate;          /* bits per sec between the last two reads */
+   int seen;                    /* 1 if found by the last read */
+};
+
+typedef struct _VfddSysStat VfddSysStat;
+
+struct _VfddSysStat {
+   AppClass parent;
+   SysStatFile files[SYSSTAT_FILES];
+   uint64_t cpu_total;          /* jiffies of the cpu line */
+   uint64_t cpu_idle;           /* idle and iowait jiffies */
+   int cpu_load;                /* busy percent between the last two reads */
+   int mem_avail;               /* available memory, MiB */
+   SysStatIface ifaces[SYSSTAT_MAX_IFACES];
+   int iface_num;
+};
+
+/*
+ * prototypes
+ */
+VfddSysStat *sysstat_new( void );
+void sysstat_construct( VfddSysStat *ss );
+void sysstat_destroy(void *ss);
+
+int sysstat_add_iface( VfddSysStat *ss, const char *name );
+void sysstat_update( VfddSysStat *ss, int file, const struct timeval *now, int fresh_ms );
+int sysstat_cpu_load( VfddSysStat *ss );
+int sysstat_mem_avail( VfddSysStat *ss );
+unsigned long sysstat_net_rate( VfddSysStat *ss, int idx );
+
+#endif /* SYSSTAT_H */
@@ -74,15 +74,14 @@ void timer_update( Timer *timer, int millisecs )
    int sec = millis  / 1000;
    int usec = (millis % 1000) * 1000;
 
+   timer->millisecs.tv_sec = sec;
+   timer->millisecs.tv_usec = usec;
    gettimeofday(&timer->when, NULL);
    if ( millisecs < 0) {
       timer->when.tv_sec += 1;
    } else {
-      timer->when.tv_sec += sec;
-      timer->when.tv_usec += usec;
+      timeradd(&timer->when, &timer->millisecs, &timer->when );
    }
-   timer->millisecs.tv_sec = sec;
-   timer->millisecs.tv_usec = usec;
 }
 
 void timer_modify( Timer *timer, int millisecs, Timer_Timeout_FP func )
@@ -91,6 +90,15 @@ void timer_modify( Timer *timer, int millisecs, Timer_Timeout_FP func )
    timer->func = func;
 }
 
+/*
+ *  run the timer at an absolute time
+ *    a callback setting its timer's time is not reloaded
+ */
+void timer_set_when( Timer *timer, const struct timeval *when )
+{
+   timer->when = *when;
+}
+
 /*
  *  run function for timers
  *    called by loop iterator
@@ -103,8 +111,9 @@ int timer_iter_timer_func( AppClass *data, void *user_data )
    
    gettimeofday(&now, NULL);
    if ( timercmp(&now, &timer->when, >= ) ){
+      struct timeval when = timer->when;
       ret = timer->func ( timer->caller, timer->data );
-      if (ret == 0 ){ /* reload the timer */
+      if (ret == 0 && timercmp(&when, &timer->when, == ) ){ /* reload the timer */
 	 timeradd(&now, &timer->millisecs, &timer->when );
       }
    }
@@ -33,6 +33,7 @@ void timer_destroy(void *timer);
 
 void timer_update( Timer *timer, int seconds );
 void timer_modify( Timer *timer, int seconds, Timer_Timeout_FP func );
+void timer_set_when( Timer *timer, const struct timeval *when );
 
 int timer_iter_timer_func( AppClass *data, void *user_data );
 
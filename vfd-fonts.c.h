@@ -0,0 +1,267 @@
+/*
+ * vfd-fonts.c.h - 16-segment and 5x7 dot matrix glyph definitions
+ */
+
+
+/*
+ * Platform-independent 16-segment glyph images, bit n is segment n
+ * of the "segment_no" configuration table. The 14-segment images
+ * are the same with a = a1|a2 and d = d1|d2.
+ *    a1   a2
+ *   ---- ----
+ *  |\   |   /|
+ *  f h  i  j b
+ *  |  \ | /  |
+ *   -g1- -g2-
+ *  |  / | \  |
+ *  e m  l  k c
+ *  |/   |   \|
+ *   ---- ----
+ *    d1   d2
+ */
+#define a1 0x0001
+#define a2 0x0002
+#define b  0x0004
+#define c  0x0008
+#define d1 0x0010
+#define d2 0x0020
+#define e  0x0040
+#define f  0x0080
+#define g1 0x0100
+#define g2 0x0200
+#define h  0x0400
+#define i  0x0800
+#define j  0x1000
+#define k  0x2000
+#define l  0x4000
+#define m  0x8000
+
+struct vfd_glyph16_t {
+   uint16_t code;
+   uint16_t image;
+};
+
+struct vfd_glyph16_t vfd_glyphs16 [] = {
+   { ' ', 0 },
+   { '!', b|c },
+   { '"', f|i },
+   { '#', b|c|d1|d2|g1|g2|i|l },
+   { '$', a1|a2|f|g1|g2|c|d1|d2|i|l },
+   { '%', a1|f|g1|i|j|m|l|g2|c|d2 },
+   { '&', a1|h|g1|e|d1|d2|k|j },
+   { '\'', i },
+   { '(', j|k },
+   { ')', h|m },
+   { '*', g1|g2|h|i|j|k|l|m },
+   { '+', g1|g2|i|l },
+   { ',', m },
+   { '-', g1|g2 },
+   { '.', d1 },
+   { '/', j|m },
+   { '0', a1|a2|b|c|d1|d2|e|f|j|m },
+   { '1', b|c|j },
+   { '2', a1|a2|b|g1|g2|e|d1|d2 },
+   { '3', a1|a2|b|g2|c|d1|d2 },
+   { '4', f|g1|g2|b|c },
+   { '5', a1|a2|f|g1|g2|c|d1|d2 },
+   { '6', a1|a2|f|e|d1|d2|c|g1|g2 },
+   { '7', a1|a2|b|c },
+   { '8', a1|a2|b|c|d1|d2|e|f|g1|g2 },
+   { '9', a1|a2|b|c|d1|d2|f|g1|g2 },
+   { ':', i|l },
+   { ';', i|m },
+   { '<', j|k },
+   { '=', g1|g2|d1|d2 },
+   { '>', h|m },
+   { '?', a1|a2|b|g2|l },
+   { '@', a1|a2|b|d1|d2|e|f|g2|i },
+   { 'A', a1|a2|b|c|e|f|g1|g2 },
+   { 'B', a1|a2|b|c|d1|d2|g2|i|l },
+   { 'C', a1|a2|d1|d2|e|f },
+   { 'D', a1|a2|b|c|d1|d2|i|l },
+   { 'E', a1|a2|d1|d2|e|f|g1 },
+   { 'F', a1|a2|e|f|g1 },
+   { 'G', a1|a2|c|d1|d2|e|f|g2 },
+   { 'H', b|c|e|f|g1|g2 },
+   { 'I', a1|a2|d1|d2|i|l },
+   { 'J', b|c|d1|d2|e },
+   { 'K', e|f|g1|j|k },
+   { 'L', d1|d2|e|f },
+   { 'M', b|c|e|f|h|j },
+   { 'N', b|c|e|f|h|k },
+   { 'O', a1|a2|b|c|d1|d2|e|f },
+   { 'P', a1|a2|b|e|f|g1|g2 },
+   { 'Q', a1|a2|b|c|d1|d2|e|f|k },
+   { 'R', a1|a2|b|e|f|g1|g2|k },
+   { 'S', a1|a2|f|g1|g2|c|d1|d2 },
+   { 'T', a1|a2|i|l },
+   { 'U', b|c|d1|d2|e|f },
+   { 'V', e|f|m|j },
+   { 'W', b|c|e|f|m|k },
+   { 'X', h|j|k|m },
+   { 'Y', h|j|l },
+   { 'Z', a1|a2|d1|d2|j|m },
+   { '[', a2|i|l|d2 },
+   { '\\', h|k },
+   { ']', a1|i|l|d1 },
+   { '^', m|k },
+   { '_', d1|d2 },
+   { '`', h },
+   { 'a', d1|e|g1|l },
+   { 'b', e|f|g1|k|d1|d2 },
+   { 'c', d1|d2|e|g1|g2 },
+   { 'd', b|c|d1|d2|g2|m },
+   { 'e', d1|e|g1|m },
+   { 'f', a2|g1|g2|i|l },
+   { 'g', a1|a2|b|c|d1|d2|f|g1|g2 },
+   { 'h', e|f|g1|l },
+   { 'i', l },
+   { 'j', c|d1|d2|e },
+   { 'k', i|l|j|k },
+   { 'l', i|l },
+   { 'm', c|e|g1|g2|l },
+   { 'n', e|g1|l },
+   { 'o', c|d1|d2|e|g1|g2 },
+   { 'p', a1|a2|b|e|f|g1|g2 },
+   { 'q', a1|a2|b|c|f|g1|g2 },
+   { 'r', e|g1 },
+   { 's', d2|g2|k },
+   { 't', d1|d2|e|f|g1 },
+   { 'u', c|d1|d2|e },
+   { 'v', e|m },
+   { 'w', c|e|k|m },
+   { 'x', h|j|k|m },
+   { 'y', b|c|d1|d2|g2|i },
+   { 'z', d1|g1|m },
+   { '{', a2|d2|g1|i|l },
+   { '|', i|l },
+   { '}', a1|d1|g2|i|l },
+   { '~', a1|a2 },
+   { 0xB0, a1|b|f|g1|i },	// degree sign
+   { 0, 0 }
+};
+
+#undef a1
+#undef a2
+#undef b
+#undef c
+#undef d1
+#undef d2
+#undef e
+#undef f
+#undef g1
+#undef g2
+#undef h
+#undef i
+#undef j
+#undef k
+#undef l
+#undef m
+
+/*
+ * 5x7 dot matrix glyph images : 5 columns from left to right,
+ * bit n is row n from the top, for ' ' to '~'
+ */
+#define FONT5X7_FIRST ' '
+#define FONT5X7_COUNT ('~' - ' ' + 1)
+
+uint8_t vfd_font5x7 [FONT5X7_COUNT][5] = {
+   { 0x00, 0x00, 0x00, 0x00, 0x00 },	//  
+   { 0x00, 0x00, 0x5F, 0x00, 0x00 },	// !
+   { 0x00, 0x07, 0x00, 0x07, 0x00 },	// "
+   { 0x14, 0x7F, 0x14, 0x7F, 0x14 },	// #
+   { 0x24, 0x2A, 0x7F, 0x2A, 0x12 },	// $
+   { 0x23, 0x13, 0x08, 0x64, 0x62 },	// %
+   { 0x36, 0x49, 0x55, 0x22, 0x50 },	// &
+   { 0x00, 0x05, 0x03, 0x00, 0x00 },	// '
+   { 0x00, 0x1C, 0x22, 0x41, 0x00 },	// (
+   { 0x00, 0x41, 0x22, 0x1C, 0x00 },	// )
+   { 0x08, 0x2A, 0x1C, 0x2A, 0x08 },	// *
+   { 0x08, 0x08, 0x3E, 0x08, 0x08 },	// +
+   { 0x00, 0x50, 0x30, 0x00, 0x00 },	// ,
+   { 0x08, 0x08, 0x08, 0x08, 0x08 },	// -
+   { 0x00, 0x60, 0x60, 0x00, 0x00 },	// .
+   { 0x20, 0x10, 0x08, 0x04, 0x02 },	// /
+   { 0x3E, 0x51, 0x49, 0x45, 0x3E },	// 0
+   { 0x00, 0x42, 0x7F, 0x40, 0x00 },	// 1
+   { 0x42, 0x61, 0x51, 0x49, 0x46 },	// 2
+   { 0x21, 0x41, 0x45, 0x4B, 0x31 },	// 3
+   { 0x18, 0x14, 0x12, 0x7F, 0x10 },	// 4
+   { 0x27, 0x45, 0x45, 0x45, 0x39 },	// 5
+   { 0x3C, 0x4A, 0x49, 0x49, 0x30 },	// 6
+   { 0x01, 0x71, 0x09, 0x05, 0x03 },	// 7
+   { 0x36, 0x49, 0x49, 0x49, 0x36 },	// 8
+   { 0x06, 0x49, 0x49, 0x29, 0x1E },	// 9
+   { 0x00, 0x36, 0x36, 0x00, 0x00 },	// :
+   { 0x00, 0x56, 0x36, 0x00, 0x00 },	// ;
+   { 0x00, 0x08, 0x14, 0x22, 0x41 },	// <
+   { 0x14, 0x14, 0x14, 0x14, 0x14 },	// =
+   { 0x41, 0x22, 0x14, 0x08, 0x00 },	// >
+   { 0x02, 0x01, 0x51, 0x09, 0x06 },	// ?
+   { 0x32, 0x49, 0x79, 0x41, 0x3E },	// @
+   { 0x7E, 0x11, 0x11, 0x11, 0x7E },	// A
+   { 0x7F, 0x49, 0x49, 0x49, 0x36 },	// B
+   { 0x3E, 0x41, 0x41, 0x41, 0x22 },	// C
+   { 0x7F, 0x41, 0x41, 0x22, 0x1C },	// D
+   { 0x7F, 0x49, 0x49, 0x49, 0x41 },	// E
+   { 0x7F, 0x09, 0x09, 0x01, 0x01 },	// F
+   { 0x3E, 0x41, 0x41, 0x51, 0x32 },	// G
+   { 0x7F, 0x08, 0x08, 0x08, 0x7F },	// H
+   { 0x00, 0x41, 0x7F, 0x41, 0x00 },	// I
+   { 0x20, 0x40, 0x41, 0x3F, 0x01 },	// J
+   { 0x7F, 0x08, 0x14, 0x22, 0x41 },	// K
+   { 0x7F, 0x40, 0x40, 0x40, 0x40 },	// L
+   { 0x7F, 0x02, 0x04, 0x02, 0x7F },	// M
+   { 0x7F, 0x04, 0x08, 0x10, 0x7F },	// N
+   { 0x3E, 0x41, 0x41, 0x41, 0x3E },	// O
+   { 0x7F, 0x09, 0x09, 0x09, 0x06 },	// P
+   { 0x3E, 0x41, 0x51, 0x21, 0x5E },	// Q
+   { 0x7F, 0x09, 0x19, 0x29, 0x46 },	// R
+   { 0x46, 0x49, 0x49, 0x49, 0x31 },	// S
+   { 0x01, 0x01, 0x7F, 0x01, 0x01 },	// T
+   { 0x3F, 0x40, 0x40, 0x40, 0x3F },	// U
+   { 0x1F, 0x20, 0x40, 0x20, 0x1F },	// V
+   { 0x7F, 0x20, 0x18, 0x20, 0x7F },	// W
+   { 0x63, 0x14, 0x08, 0x14, 0x63 },	// X
+   { 0x03, 0x04, 0x78, 0x04, 0x03 },	// Y
+   { 0x61, 0x51, 0x49, 0x45, 0x43 },	// Z
+   { 0x00, 0x00, 0x7F, 0x41, 0x41 },	// [
+   { 0x02, 0x04, 0x08, 0x10, 0x20 },	// backslash
+   { 0x41, 0x41, 0x7F, 0x00, 0x00 },	// ]
+   { 0x04, 0x02, 0x01, 0x02, 0x04 },	// ^
+   { 0x40, 0x40, 0x40, 0x40, 0x40 },	// _
+   { 0x00, 0x01, 0x02, 0x04, 0x00 },	// `
+   { 0x20, 0x54, 0x54, 0x54, 0x78 },	// a
+   { 0x7F, 0x48, 0x44, 0x44, 0x38 },	// b
+   { 0x38, 0x44, 0x44, 0x44, 0x20 },	// c
+   { 0x38, 0x44, 0x44, 0x48, 0x7F },	// d
+   { 0x38, 0x54, 0x54, 0x54, 0x18 },	// e
+   { 0x08, 0x7E, 0x09, 0x01, 0x02 },	// f
+   { 0x08, 0x14, 0x54, 0x54, 0x3C },	// g
+   { 0x7F, 0x08, 0x04, 0x04, 0x78 },	// h
+   { 0x00, 0x44, 0x7D, 0x40, 0x00 },	// i
+   { 0x20, 0x40, 0x44, 0x3D, 0x00 },	// j
+   { 0x00, 0x7F, 0x10, 0x28, 0x44 },	// k
+   { 0x00, 0x41, 0x7F, 0x40, 0x00 },	// l
+   { 0x7C, 0x04, 0x18, 0x04, 0x78 },	// m
+   { 0x7C, 0x08, 0x04, 0x04, 0x78 },	// n
+   { 0x38, 0x44, 0x44, 0x44, 0x38 },	// o
+   { 0x7C, 0x14, 0x14, 0x14, 0x08 },	// p
+   { 0x08, 0x14, 0x14, 0x18, 0x7C },	// q
+   { 0x7C, 0x08, 0x04, 0x04, 0x08 },	// r
+   { 0x48, 0x54, 0x54, 0x54, 0x20 },	// s
+   { 0x04, 0x3F, 0x44, 0x40, 0x20 },	// t
+   { 0x3C, 0x40, 0x40, 0x20, 0x7C },	// u
+   { 0x1C, 0x20, 0x40, 0x20, 0x1C },	// v
+   { 0x3C, 0x40, 0x30, 0x40, 0x3C },	// w
+   { 0x44, 0x28, 0x10, 0x28, 0x44 },	// x
+   { 0x0C, 0x50, 0x50, 0x50, 0x3C },	// y
+   { 0x44, 0x64, 0x54, 0x4C, 0x44 },	// z
+   { 0x00, 0x08, 0x36, 0x41, 0x00 },	// {
+   { 0x00, 0x00, 0x7F, 0x00, 0x00 },	// |
+   { 0x00, 0x41, 0x36, 0x08, 0x00 },	// }
+   { 0x02, 0x01, 0x02, 0x04, 0x02 },	// ~
+};
+
+/* 5x7 degree sign */
+uint8_t vfd_font5x7_degree [5] = { 0x00, 0x06, 0x09, 0x09, 0x06 };
@@ -4,7 +4,8 @@
 
 
 /*
- * Platform-independent glyph images
+ * Platform-independent glyph images, bit n is segment n of
+ * the "segment_no" configuration table
  *     a
  *    ---
  * f |   | b
@@ -13,12 +14,12 @@
  *    ---
  *     d
  */
-#define a 0x08
-#define b 0x10
-#define c 0x20
-#define d 0x01
-#define e 0x02
-#define f 0x04
+#define a 0x01
+#define b 0x02
+#define c 0x04
+#define d 0x08
+#define e 0x10
+#define f 0x20
 #define g 0x40
 
 struct vfd_glyph_t {
@@ -102,3 +103,11 @@ struct vfd_glyph_t vfd_glyphs [] = {
    { 'z', a|b|g|e|d },
    { 0, 0 }
 };
+
+#undef a
+#undef b
+#undef c
+#undef d
+#undef e
+#undef f
+#undef g
@@ -8,16 +8,24 @@
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <sys/time.h>
+#include <sys/stat.h>
 
 #include <vfdd.h>
 #include <mdbuf.h>
-#include <dotled.h>
-#include <display.h>
+#include <panel.h>
+#include <diskstats.h>
+#include <sysstat.h>
+#include <source.h>
+#include <sensors.h>
 #include <duprintf.h>
 
-
-#define RENDER_TBL_SIZ (0x7E - 0x20)
-#include <vfd-glyphs.c.h>
+/* default time to prepare a frame before its boundary */
+#define VFDD_LEAD_MS 50
+/* longest sleep between two frames, secs */
+#define VFDD_MAX_SLEEP 60
+/* default dir of the files kept across restarts */
+#define VFDD_STATE_DIR "/var/lib/vfdd"
 
 /*
  *** \brief Allocates memory for a new Vfdd object.
@@ -40,25 +48,26 @@ void vfdd_construct( Vfdd *vf, char *conffile )
    app_class_construct( (AppClass *) vf );
 
    vf->conffile = conffile;
+   vf->lead = VFDD_LEAD_MS;
+   /* the configuration adds channels and timers to the loop */
+   vf->loop = loop_new( LOOP_NB_CHANNEL, vf );
+   vf->notify = notify_new( vf->loop );
    if ( vfdd_read_conf (vf ) < 0 ){
       msg_fatal("Error reading configuration file '%s'", vf->conffile);
    }
    vf->interval = 500;
    vf->vftm = app_new0(struct tm, 1 );
+   vf->cal = calendar_new();
 
-   vf->loop = loop_new( LOOP_NB_CHANNEL, vf );
    /* timer must exist for timer_update */
    vf->timer = timer_new( (AppClass *) vf, vf->interval,
                                 vfdd_timer_cb, NULL );
 
-   /* the -ud->interval will run the callback  1 second later */
+   /* the first frame is prepared for the next boundary */
+   vfdd_arm_next_tick( vf );
+   notify_set_changed_func( vf->notify, vfdd_wake, vf );
+   alarm_set_changed_func( vf->alarms, vfdd_wake, vf );
    loop_timer_add(vf->loop, vf->timer );
-   
-   DotLed *led = (DotLed *) dlist_lookup( vf->dots, (AppClass *) "colon",
-					  dotled_name_str_cmp );
-   if ( led ) {
-      dotled_set_cb_func( led, vfdd_get_colon, vf );
-   }
 }
 
 /** \brief Destructor for the Vfdd object. */
@@ -70,53 +79,51 @@ void vfdd_destroy(void *vf)
    if (vf == NULL) {
       return;
    }
+   if ( this->glass_num ){
+      msg_info( "boundary to glass latency min %ld avg %ld max %ld us, %lu writes, prepare max %ld us",
+		this->glass_min, this->glass_sum / (long) this->glass_num,
+		this->glass_max, this->glass_num, this->prepare_max );
+   }
    loop_destroy( this->loop ); /* this should remove the timer */
-   dlist_delete_all( this->dots );
-   dlist_delete_all( this->listCbs );
-   app_free(this->device);
-   app_free(this->overlay);
-   app_free(this->render_tbl);
-   app_free(this->display_raw);
-   app_free(this->digit_map);
+   control_destroy( this->control );
+   alarm_destroy( this->alarms );
+   notify_destroy( this->notify );
+   dlist_delete_all( this->panels );
+   diskstats_destroy( this->disks );
+   sysstat_destroy( this->sysstat );
+   sensors_destroy( this->sensors );
+   app_free(this->state_dir);
+   dlist_delete_all( this->sources );
    app_free(this->vftm);
-   app_free(this->display_str);
+   calendar_destroy(this->cal);
    
    app_class_destroy( vf );
 }
 
-int vfdd_iter_dotled_funcs( AppClass *data, void *user_data )
+/*
+ * the "stats" command : the frame latencies and the files read
+ */
+int vfdd_log_stats( AppClass *xvf, void *user_data )
 {
-   JsonNode *node = (JsonNode *) data;
-   Vfdd *vf = (Vfdd *) user_data;
-   int result;
-   
-   JsonNode *n = json_root_get_item_bool(node, "enable",  &result );
-   if ( n == NULL || result == 0 ){
-      return 0;
-   }
-
-   DotLed *led = dotled_new( (AppClass *) node, &vf->display_raw[vf->dotled_map] );
-   vf->dots = dlist_add_tail(vf->dots, (AppClass *) led );
+   Vfdd *vf = (Vfdd *) xvf;
 
-   msg_dbg( "dotled '%s' %d \n", node->keyname, vf->dotled_map );
+   msg_info( "%lu frames prepared, %lu writes, prepare max %ld us",
+	     vf->timer_count, vf->glass_num, vf->prepare_max );
+   if ( vf->glass_num ){
+      msg_info( "boundary to glass latency min %ld avg %ld max %ld us",
+		vf->glass_min, vf->glass_sum / (long) vf->glass_num, vf->glass_max );
+   }
+   dlist_iterator(vf->sources, source_iter_log_stats, NULL );
    return 0;
 }
 
-int vfdd_iter_vfdd_funcs( AppClass *data, void *user_data )
+int vfdd_iter_panels( AppClass *data, void *user_data )
 {
    JsonNode *node = (JsonNode *) data;
    Vfdd *vf = (Vfdd *) user_data;
-   int result;
-   
-   JsonNode *n = json_root_get_item_bool(node, "enable",  &result );
-   if ( n == NULL || result == 0 ){
-      return 0;
-   }
-
-   VfddDisplay *dis = display_new( (AppClass *) node, (AppClass *) vf );
-   vf->listCbs = dlist_add_tail(vf->listCbs, (AppClass *) dis );
 
-   msg_dbg( "vfdd_funcd '%s'\n", node->keyname );
+   VfddPanel *pa = panel_new( (AppClass *) node, vf, vf->panel_num++ );
+   vf->panels = dlist_add_tail(vf->panels, (AppClass *) pa );
    return 0;
 }
 
@@ -125,9 +132,6 @@ int vfdd_read_conf(Vfdd *vf)
    char *end;
    JsonRootNode *root = NULL;
    JsonNode *node;
-   char *name;
-   int count;
-   int i;
    int ret = -1;
 
    MDbuf *mdbuf = mdbuf_new( vf->conffile, O_RDONLY );
@@ -143,77 +147,55 @@ int vfdd_read_conf(Vfdd *vf)
       goto enderr;
    }
 
-   if ( msg_get_dbg_msk() & DBG_1 ){
-      json_root_print(root, 1);
-      printf("%s\n", root->dbuf->s);
+   int lead;
+   if ( json_root_get_item_int((JsonNode *) root, "prerender_ms", &lead ) ){
+      vf->lead = lead;
    }
-   
-   node = json_node_find_node((JsonNode *) root, "display" );
-   if ( node ) {
 
-      json_root_get_item_string(node, "device", &name );
-      if ( name ){
-         vf->device = app_strdup(name);
-      }
-      json_root_get_item_string(node, "sysfile", &name );
-      if ( name ){
-         vf->overlay = app_strdup_printf("%s/%s", vf->device, name);
-      }
-
-      json_root_get_item_int( node, "grid_num", &vf->grid_num );
-      vf->display_raw = app_new0(uint16_t, vf->grid_num );
-
-      JsonNode *array = json_root_get_item_nelem( node, "segment_no", &count);
-      if ( array ){
-	 /* segno : bit num for segment a b c ... */
-	 uint8_t *segno = app_new0( uint8_t, count );
-	 for ( i = 0 ; i < count ; i++ ){
-	    JsonNode *item = json_node_get_nth_child( array, i );
-	    if ( ! item ){
-	       continue;
-	    }
-	    int val;
-	    json_node_get_val_int(item, &val );
-	    segno[i] = val;
-   	 }
-	 vfdd_init_render_tbl ( vf, segno);
-	 app_free (segno);
-      }
-
-      array = json_root_get_item_nelem( node, "digit_map", &count);
-      if ( array ){
-	 /* segno : bit num for segment a b c ... */
-	 vf->digit_num = count ;
-	 vf->digit_map = app_new0( uint8_t, count );
-	 for ( i = 0 ; i < count ; i++ ){
-	    JsonNode *item = json_node_get_nth_child( array, i );
-	    if ( ! item ){
-	       continue;
-	    }
-	    int val;
-	    json_node_get_val_int(item, &val );
-	    vf->digit_map[i] = val;
-   	 }
-      }
-
-      json_root_get_item_int( node, "brightness", &vf->brightness );
-
-      JsonNode *object = json_node_find_node( node, "functions");
-      if ( object ){
-	 dlist_iterator(object->child, vfdd_iter_vfdd_funcs, vf );
-      }
-   }
-   
-   node = json_node_find_node((JsonNode *) root, "dotleds" );
+   /* "notifications" : [ { "text": ..., "priority": ..., "ttl": ... }, ... ] */
+   node = json_node_find_node((JsonNode *) root, "notifications" );
    if ( node ) {
+      dlist_iterator(node->child, notify_iter_conf, vf->notify );
+   }
+   char *name;
+   /* "state_dir" : created if it does not exist */
+   json_root_get_item_string((JsonNode *) root, "state_dir", &name );
+   vf->state_dir = app_strdup( name ? name : VFDD_STATE_DIR );
+   if ( mkdir( vf->state_dir, 0755 ) < 0 && errno != EEXIST ){
+      msg_error( "Failed to create dir '%s' - %s", vf->state_dir, strerror(errno) );
+   }
 
-      json_root_get_item_int( node, "grid_map", &vf->dotled_map );
+   /* "alarms" : [ { "time": "07:30", "days": "1-5", "duration": 120 } ],
+    * with the ones set through the fifo */
+   vf->alarms = alarm_new( vf->loop, vf->notify, vf->state_dir );
+   node = json_node_find_node((JsonNode *) root, "alarms" );
+   if ( node ) {
+      dlist_iterator(node->child, alarm_iter_conf, vf->alarms );
+   }
+   json_root_get_item_string((JsonNode *) root, "alarm_text", &name );
+   if ( name ){
+      app_dup_str( &vf->alarms->text, name );
+   }
 
-      JsonNode *object = json_node_find_node( node, "functions" );
-      if ( object ){
-	 dlist_iterator(object->child, vfdd_iter_dotled_funcs, vf );
-      }
+   json_root_get_item_string((JsonNode *) root, "control", &name );
+   if ( name ){
+      vf->control = control_new( vf->loop, name, vf->notify );
+      control_set_stats_func( vf->control, vfdd_log_stats, vf );
+      control_set_alarms( vf->control, vf->alarms );
+   }
 
+   if ( msg_get_dbg_msk() & DBG_1 ){
+      json_root_print(root, 1);
+      printf("%s\n", root->dbuf->s);
+   }
+   
+   /* "displays" : [ { "display": ..., "dotleds": ... }, ... ]
+    * or a single panel at the root */
+   node = json_node_find_node((JsonNode *) root, "displays" );
+   if ( node ) {
+      dlist_iterator(node->child, vfdd_iter_panels, vf );
+   } else {
+      vfdd_iter_panels( (AppClass *) root, vf );
    }
    ret = 0;
 
@@ -230,100 +212,158 @@ int vfdd_get_colon( AppClass *xvf, void *user_data )
    
 }
 
-uint8_t getMyGlyph(char letter) {
-for(int i =0; i< sizeof(vfd_glyphs); i++){
-   if(letter == vfd_glyphs[i].code)
-   return vfd_glyphs[i].image;
-}
-return vfd_glyphs[0].image;
-}
 /*
- * Convert a string of 8-bit characters into a string of 16-bit
- * display bitmasks
+ * The timer alternates two steps on the interval boundaries where
+ * a panel has a change :
+ *   lead milisecs before, the panels prepare the frame of the boundary,
+ *   on the boundary, the prepared frames are written.
  */
-void vfdd_update_display (Vfdd *vf )
+int vfdd_timer_cb(AppClass *xvf, AppClass *user_data )
 {
-   int i;
-   int k;
-   char *dstr = vf->display_str;
-   msg_dbgl( DBG_2, "converting '%s' colon %d", dstr, !! (vf->display_raw[vf->dotled_map] & 4) );
-
-   for (i = 0; i < vf->digit_num; i++) {
-      uint8_t ch = dstr[i] - ' ';
-      /* digit_map says : ch[0] go to mem digit_map[0] , ... */
-      k = vf->digit_map[i];
-
-      if ( ch >= RENDER_TBL_SIZ ){
-         ch = 0;
-      }
-      msg_dbgl(  DBG_2, "k %d ch 0x%X  render 0x%X", k, ch, vf->render_tbl[ch] );
-     
-//      vf->display_raw[k] = vf->render_tbl[ch];
-      // ! GO 1
-       // vf->display_raw[3] = getMyGlyph('d');
-       
-
-// ! GO 2
-      //   vf->display_raw[3] =  vfd_glyphs[63].image;
-      //   vf->display_raw[2] = vfd_glyphs[66].image;
-      //   vf->display_raw[1] = vfd_glyphs[59].image;
-
+   Vfdd *vf = (Vfdd  *) xvf;
 
+   /* a word given on the command line is displayed once */
+   if ( vf->word ){
+      gettimeofday(&vf->tick, NULL);
+      vfdd_prepare( vf );
+      vfdd_commit( vf );
+      loop_quit( vf->loop );
+      return 0;
    }
-    printf("Printing %s\n",vf->word);
-   // ! done
-        vf->display_raw[3] =  getMyGlyph(vf->word[0]);
-         vf->display_raw[2] =getMyGlyph(vf->word[1]);
-         vf->display_raw[1] = getMyGlyph(vf->word[2]);
-        vf->display_raw[0] = getMyGlyph(vf->word[3]);
-
-      
- 
+   if ( vf->prepared ){
+      vfdd_commit( vf );
+      vfdd_arm_next_tick( vf );
+   } else {
+      vfdd_prepare( vf );
+      timer_set_when( vf->timer, &vf->tick );
+   }
+   return 0;
 }
 
+/*
+ * set tick to the first interval boundary at due, or the next one if
+ * due is past, leaving lead milisecs to prepare its frame, and run the
+ * timer then
+ */
+void vfdd_arm_next_tick( Vfdd *vf )
+{
+   struct timeval now, lead, when, from;
+   long step = vf->interval * 1000L;
+
+   gettimeofday(&now, NULL);
+   lead.tv_sec = vf->lead / 1000;
+   lead.tv_usec = (vf->lead % 1000) * 1000;
+
+   from = vf->due;
+   if ( ! timercmp(&from, &now, > ) ){
+      struct timeval usec = { 0, 1 };
+      timeradd(&now, &usec, &from);
+   } else if ( from.tv_sec - now.tv_sec > VFDD_MAX_SLEEP ){
+      from.tv_sec = now.tv_sec + VFDD_MAX_SLEEP;
+   }
 
+   /* boundaries are multiples of the interval within the second */
+   long usec = ( from.tv_usec + step - 1 ) / step * step;
+   vf->tick.tv_sec = from.tv_sec + usec / 1000000;
+   vf->tick.tv_usec = usec % 1000000;
+   timersub(&vf->tick, &lead, &when);
+   if ( timercmp(&when, &now, < ) ){
+      /* too late for this one */
+      struct timeval interval = { step / 1000000, step % 1000000 };
+      timeradd(&vf->tick, &interval, &vf->tick);
+      timeradd(&when, &interval, &when);
+   }
+   timer_set_when( vf->timer, &when );
+}
 
+/*
+ * a panel has a change at when, a time at or before tick is
+ * the next boundary
+ */
+void vfdd_set_due( Vfdd *vf, const struct timeval *when )
+{
+   if ( timercmp(when, &vf->due, < ) ){
+      vf->due = *when;
+   }
+}
 
-void vfdd_overlay_store (Vfdd *vf )
+/*
+ * something shown has changed out of the panel schedule :
+ * prepare the next boundary
+ */
+int vfdd_wake( AppClass *xvf, void *user_data )
 {
-   int i;
+   Vfdd *vf = (Vfdd  *) xvf;
 
-   FILE *fd = fopen( vf->overlay, "w");
-   if ( ! fd ){
-      msg_error("Failed to open file '%s' - %s", vf->overlay, strerror(errno) );
-      return;
-   }
-   msg_dbg( "writing to '%s'", vf->overlay );
-   for (i = 0; i < vf->grid_num; i++) {
-      fprintf(fd, "%04X ", vf->display_raw[i] ) ;
+   timerclear( &vf->due );
+   /* a prepared frame is followed by the next boundary */
+   if ( ! vf->prepared && ! vf->word ){
+      vfdd_arm_next_tick( vf );
    }
-   fclose(fd);
+   return 0;
 }
 
-int vfdd_timer_cb(AppClass *xvf, AppClass *user_data )
+/*
+ * build the frames of tick, reading the sources they need
+ */
+void vfdd_prepare( Vfdd *vf )
 {
-   Vfdd *vf = (Vfdd  *) xvf;
-   vf->timer_count++;
+   struct timeval start, end, took;
 
-   memset( vf->display_raw, 0, vf->grid_num * 2 );
-   time(&vf->curtime);
-   localtime_r(&vf->curtime, vf->vftm );
-   dlist_iterator(vf->listCbs, display_iter_update_cb, vf );
-   dlist_iterator(vf->dots, dotled_iter_update, vf );
+   gettimeofday(&start, NULL);
+   vf->timer_count++;
 
-   vfdd_update_display ( vf );
-   vfdd_overlay_store ( vf );
-    exit(1); //! Exit 
-   return 0;   
-   
+   /* the time is read once for all panels : the time shown at tick */
+   vf->curtime = vf->tick.tv_sec;
+   calendar_get( vf->cal, vf->curtime, vf->vftm );
+   long ms = vf->tick.tv_sec * 1000L + vf->tick.tv_usec / 1000;
+   vf->boundary = ms / vf->interval;
+   vf->phase = vf->boundary & 1;
+
+   /* the panels bring it forward to their next change */
+   vf->due = vf->tick;
+   vf->due.tv_sec += VFDD_MAX_SLEEP;
+   dlist_iterator(vf->panels, panel_iter_prepare, vf );
+   vf->prepared = 1;
+
+   gettimeofday(&end, NULL);
+   timersub(&end, &start, &took);
+   long us = took.tv_sec * 1000000L + took.tv_usec;
+   if ( us > vf->prepare_max ){
+      vf->prepare_max = us;
+   }
 }
 
-
 /*
- * Initialize glyph images for current platform from the
- * platform-independent representation
+ * write the prepared frames and measure how late they reach the display
  */
-void vfdd_init_render_tbl ( Vfdd *vf, const uint8_t *segno)
+void vfdd_commit( Vfdd *vf )
 {
-  
+   struct timeval now, late;
+
+   vf->writes = 0;
+   dlist_iterator(vf->panels, panel_iter_commit, vf );
+   vf->prepared = 0;
+   if ( ! vf->writes ){
+      return;
+   }
+
+   gettimeofday(&now, NULL);
+   timersub(&now, &vf->tick, &late);
+   long us = late.tv_sec * 1000000L + late.tv_usec;
+   if ( vf->glass_num == 0 || us < vf->glass_min ){
+      vf->glass_min = us;
+   }
+   if ( us > vf->glass_max ){
+      vf->glass_max = us;
+   }
+   vf->glass_sum += us;
+   vf->glass_num++;
+   msg_dbgl( DBG_2, "frame of %ld.%06ld written %ld us late",
+	     (long) vf->tick.tv_sec, (long) vf->tick.tv_usec, us );
+   if ( vf->glass_num % 60 == 0 ){
+      msg_dbg( "boundary to glass latency min %ld avg %ld max %ld us over %lu writes",
+	       vf->glass_min, vf->glass_sum / (long) vf->glass_num,
+	       vf->glass_max, vf->glass_num );
+   }
 }
@@ -12,6 +12,10 @@
 #include <loop.h>
 #include <timerms.h>
 #include <jsonroot.h>
+#include <calendar.h>
+#include <notify.h>
+#include <control.h>
+#include <alarm.h>
 
 typedef struct _Vfdd Vfdd;
 
@@ -19,25 +23,36 @@ struct _Vfdd {
    AppClass parent;
    Loop *loop;             /* the main loop */
    Timer *timer;           /* the main timer */
-   uint16_t *display_raw;  /* data to be transmitted to display */
-   DList *dots;            /* list of dotled object */
-   DList *listCbs;         /* list of vfdd funcs callback */
-   uint8_t *render_tbl;    /* table to convert an ascii symbol to a display image */
-   uint8_t *digit_map;     /* table of digit address */
+   DList *panels;          /* list of VfddPanel objects, one per display */
+   DList *sources;         /* list of VfddSource objects, shared by the panels */
    char *conffile;         /* pointer to configuration filename  */
-   char *device;           /* vfd device name */
-   char *overlay;          /* name of the overlay sys file */
-   char *display_str;      /* sting to be displayed */
-   unsigned long timer_count;  /* count timer interrupt every 500 ms */
-   time_t curtime;         /* current time */
-   int digit_num;          /* number of digit in display */
-   int grid_num;           /* number of ram address in display */
-   int dotled_map;         /* ram address for dotleds */
-   int brightness;         /* default led brightness (0 to 100%) */
-   int interval;           /* time to wait milisecs before next callback */
+   unsigned long timer_count;  /* count of prepared frames */
+   time_t curtime;         /* time of the frame shown at tick */
+   struct timeval tick;    /* boundary the prepared frame is shown at */
+   struct timeval due;     /* earliest change the panels have after tick */
+   unsigned long boundary; /* boundaries from the epoch to tick */
+   int phase;              /* blink phase of tick, 0 or 1 */
+   int lead;               /* milisecs to prepare a frame before its boundary */
+   int prepared;           /* 1 if the panels hold the frame of tick */
+   int writes;             /* panels written at the last commit */
+   long glass_min;         /* boundary to written frame latency, microsecs */
+   long glass_max;
+   long glass_sum;
+   unsigned long glass_num;  /* commits with a write */
+   long prepare_max;       /* longest frame preparation, microsecs */
+   int panel_num;          /* number of panels */
+   int interval;           /* milisecs between two boundaries */
    int nocolon;            /* set to 1 if date, temp is displayed */
    int status;             /* operation status */
    struct tm *vftm;        /* structure tm */
+   VfddCalendar *cal;      /* local time of the current minute */
+   VfddNotify *notify;     /* notifications shown instead of the functions */
+   VfddControl *control;   /* command fifo, NULL if none */
+   VfddAlarms *alarms;     /* alarm clock */
+   struct _VfddDiskStats *disks;  /* disk activity, NULL without disk dotled */
+   struct _VfddSysStat *sysstat;  /* cpu, memory and network, NULL without their functions */
+   struct _VfddSensors *sensors;  /* sensors found by name, NULL if none is named */
+   char *state_dir;        /* dir of the files kept across restarts */
    char *word; /*the word to print*/
 };
 
@@ -51,11 +66,12 @@ void vfdd_destroy(void *vf);
 int vfdd_get_colon( AppClass *xvf, void *user_data );
 int vfdd_read_conf(Vfdd *vf);
 int vfdd_timer_cb(AppClass *xvf, AppClass *user_data );
-void vfdd_init_render_tbl ( Vfdd *vf, const uint8_t *segno);
-int vfdd_iter_dotled_funcs( AppClass *data, void *user_data );
-int vfdd_iter_vfdd_funcs( AppClass *data, void *user_data );
-void vfdd_update_display (Vfdd *vf );
-uint8_t getMyGlyph(char letter);
-void vfdd_overlay_store (Vfdd *vf );
+void vfdd_prepare( Vfdd *vf );
+void vfdd_commit( Vfdd *vf );
+void vfdd_arm_next_tick( Vfdd *vf );
+void vfdd_set_due( Vfdd *vf, const struct timeval *when );
+int vfdd_wake( AppClass *xvf, void *user_data );
+int vfdd_log_stats( AppClass *xvf, void *user_data );
+int vfdd_iter_panels( AppClass *data, void *user_data );
 
 #endif /* VFDD_H */
@@ -37,6 +37,7 @@ void usage(UserData *ud);
 /* */
 
 #define APPVFDDRC_FILE "/etc/vfdd.conf"
+#define APPVFDDNETRC_FILE "/etc/net.conf"
 const char version[] = PJVERSION;
 
 
@@ -59,7 +60,10 @@ void usage(UserData *ud)
 {
    fprintf( stderr,
 "vfdd is a demon program to drive a led display\n"
-"vfdd [options]\n"
+"vfdd [options] [word [colon [net]]]\n"
+"  word            : display the word once and exit\n"
+"  colon           : 1 to light the colon with the word\n"
+"  net             : 1 to read the configuration from %s\n"
 "  -v              : verbose\n"
 "  -dm level list  : set debug mask : -dm 8,9\n"
 "  -h              : print this help message\n"
@@ -70,12 +74,14 @@ void usage(UserData *ud)
 "  -V              |\n"
 "  --version       : print version number and exit.\n"
 "  ex: vfdd -D     : run in background\n",
-    ud->conffile );
+    APPVFDDNETRC_FILE, APPVFDDRC_FILE );
 }
 
 int main(int argc, char **argv, char **envp)
 {
    int i ;
+   int npos = 0;
+   int net = 0;
    int ret = 0;
    UserData *ud;
    int log_facility = LOG_DAEMON;
@@ -84,17 +90,7 @@ int main(int argc, char **argv, char **envp)
    ud = userData = app_new0(UserData, 1);
    ud->prog = basename(argv[0]);
    ud->serverMode = LM_STANDALONE;
-   ud->word = argv[1];
-   ud->colon = atoi(argv[2]);
-     printf("%s word \n", argv[1]);
- int num = atoi(argv[2]);
-  printf("%d colon \n", num);
    msg_initlog( ud->prog , MSG_F_NO_DATE | MSG_F_COLOR, NULL, NULL );
-    printf("%d net \n", atoi(argv[3]));
-    if(atoi(argv[3]) == 1)
-   ud->conffile = app_strdup( "/etc/net.conf" );
-    else
-   ud->conffile = app_strdup( "/etc/vfdd.conf" );
 
    for (i = 1 ; i < argc ; i++) {
       if (*argv[i] == '-') {
@@ -124,8 +120,20 @@ int main(int argc, char **argv, char **envp)
             fprintf( stdout, "%s\n", PJVERSION );
             goto enderr;
 	 }
+      } else if ( npos == 0 ){
+         ud->word = argv[i];
+         npos++;
+      } else if ( npos == 1 ){
+         ud->colon = atoi(argv[i]);
+         npos++;
+      } else if ( npos == 2 ){
+         net = atoi(argv[i]);
+         npos++;
       }
    }
+   if ( ! ud->conffile ){
+      ud->conffile = app_strdup( net == 1 ? APPVFDDNETRC_FILE : APPVFDDRC_FILE );
+   }
    msg_set_level(ud->verbose + 1);
 
    if ( ud->log_file ){
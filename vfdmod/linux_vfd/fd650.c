@@ -0,0 +1,160 @@
+/*
+ * VFD backend for FD650, TM1650 LED driver chips.
+ *
+ * These chips use a 2-wire bus close to I2C (no device address,
+ * MSB first, an ack bit after every byte) with one command per digit,
+ * so an update only sends the digits that changed, 2 bytes each.
+ * The bus signals are CLK and DI/DO, STB is not used.
+ */
+
+#include <linux/kernel.h>
+#include <linux/gpio/consumer.h>
+
+#include "fd650.h"
+#include "vfd-bus.h"
+
+// Start condition: DIO falls while CLK is high, leaves CLK low
+static void fd650_start(struct vfd_t *vfd)
+{
+   DO(vfd, 1);
+   CLK(vfd, 1);
+   ndelay(400);
+   DO(vfd, 0);
+   ndelay(400);
+   CLK(vfd, 0);
+}
+
+// Stop condition: DIO rises while CLK is high
+static void fd650_stop(struct vfd_t *vfd)
+{
+   DO(vfd, 0);
+   CLK(vfd, 1);
+   ndelay(400);
+   DO(vfd, 1);
+   ndelay(400);
+}
+
+// Clock one bit out of the chip or into it; assumes CLK low
+static void fd650_clock(struct vfd_t *vfd)
+{
+   ndelay(400);
+   CLK(vfd, 1);
+   ndelay(400);
+   CLK(vfd, 0);
+}
+
+// Send a byte MSB first and skip the ack bit; assumes CLK low
+static void fd650_send(struct vfd_t *vfd, u8 data)
+{
+   int i;
+
+   for (i = 8; i != 0; i--, data <<= 1) {
+      DO(vfd, data & 0x80);
+      fd650_clock(vfd);
+   }
+   /* the chip pulls DIO low to ack, release the line */
+   DI(vfd);
+   fd650_clock(vfd);
+}
+
+static void fd650_cmd(struct vfd_t *vfd, u8 cmd, u8 data)
+{
+   fd650_start(vfd);
+   fd650_send(vfd, cmd);
+   fd650_send(vfd, data);
+   fd650_stop(vfd);
+}
+
+#ifndef CONFIG_VFD_NO_KEY_INPUT
+
+// Receive a byte MSB first, answer with no-ack; assumes CLK low
+static u8 fd650_read(struct vfd_t *vfd)
+{
+   int i;
+   u8 d = 0;
+
+   DI(vfd);
+   for (i = 0; i < 8; i++) {
+      ndelay(400);
+      CLK(vfd, 1);
+      ndelay(400);
+      d = (d << 1) | (DI(vfd) ? 1 : 0);
+      CLK(vfd, 0);
+   }
+   DO(vfd, 1);
+   fd650_clock(vfd);
+
+   return d;
+}
+
+/*
+ * The chip only reports the last key, the key state bitmap has
+ * bit (DIG * 4 + KI) set while it is down.
+ */
+static u32 fd650_keys(struct vfd_t *vfd)
+{
+   u8 code;
+
+   fd650_start(vfd);
+   fd650_send(vfd, FD650_CMD_READ_KEYS);
+   code = fd650_read(vfd);
+   fd650_stop(vfd);
+
+   if ( ! (code & FD650_KEY_DOWN)) {
+      return 0;
+   }
+   return 1U << (FD650_KEY_DIG(code) * 4 + FD650_KEY_KI(code));
+}
+
+#else
+#define fd650_keys NULL
+#endif
+
+static void fd650_set_brightness(struct vfd_t *vfd, int bri)
+{
+   if (bri == 0){
+      fd650_cmd(vfd, FD650_CMD_SYSTEM, FD650_CONTROL_OFF);
+   } else {
+      fd650_cmd(vfd, FD650_CMD_SYSTEM, FD650_CONTROL(bri));
+   }
+}
+
+// Each digit has its own command, only the low byte of a word is used
+static void fd650_update_range(struct vfd_t *vfd, int first, int count)
+{
+   int i;
+
+   for (i = first; i < first + count; i++) {
+      fd650_cmd(vfd, FD650_CMD_DIGIT(i), vfd->raw_display [i] & 0xff);
+   }
+}
+
+static int fd650_init(struct vfd_t *vfd)
+{
+   int i;
+
+   DBG_TRACE;
+
+   // set up GPIO modes, the bus is idle with both lines high
+   gpiod_direction_output(vfd->gpio_desc [GPIO_CLK], 1);
+   gpiod_direction_output(vfd->gpio_desc [GPIO_DIDO], 1);
+   vfd->dido_gpio_out = 1;
+
+   udelay(10);
+
+   for (i = 0; i < FD650_DIGITS; i++) {
+      fd650_cmd(vfd, FD650_CMD_DIGIT(i), 0);
+   }
+   return 0;
+}
+
+const struct vfd_ops vfd_fd650_ops = {
+   .name           = "fd650",
+   .num_gpios      = 2,
+   .raw_words      = FD650_DIGITS,
+   .brightness_max = FD650_BRIGHTNESS_MAX,
+   .init           = fd650_init,
+   .update_range   = fd650_update_range,
+   .read_keys      = fd650_keys,
+   .set_brightness = fd650_set_brightness,
+};
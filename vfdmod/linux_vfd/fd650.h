@@ -0,0 +1,34 @@
+/*
+ * VFD backend for FD650, TM1650 LED driver chips.
+ */
+
+#ifndef __FD650_H__
+#define	__FD650_H__
+
+#include "vfd-priv.h"
+
+// System command, followed by the display control byte
+#define FD650_CMD_SYSTEM		0x48
+// Read key code
+#define FD650_CMD_READ_KEYS		0x49
+// Write digit 'n' (0-3), followed by the segment byte
+#define FD650_CMD_DIGIT(n)		(0x68 | ((n) << 1))
+
+// Display control byte: brightness 1-8 and display on
+#define FD650_CONTROL(bri)		((((bri) & 7) << 4) | 0x01)
+// Display off
+#define FD650_CONTROL_OFF		0x00
+
+// Key code: bit 6 is set while the key is down
+#define FD650_KEY_DOWN			0x40
+// Key code: digit line (DIG1-DIG4, KI5-KI7 columns as 4-6)
+#define FD650_KEY_DIG(code)		(((code) >> 3) & 7)
+// Key code: input line KI1-KI4
+#define FD650_KEY_KI(code)		((code) & 3)
+
+// 4 digits, one byte each
+#define FD650_DIGITS			4
+// 8 brighness levels
+#define FD650_BRIGHTNESS_MAX		8
+
+#endif // __FD650_H__
@@ -7,37 +7,7 @@
 #include <linux/gpio/consumer.h>
 
 #include "pt6964.h"
-
-static inline void CLK(struct vfd_t *vfd, int value)
-{
-   gpiod_set_value(vfd->gpio_desc[GPIO_CLK], value);
-}
-
-static inline void STB(struct vfd_t *vfd, int value)
-{
-   gpiod_set_value(vfd->gpio_desc[GPIO_STB], value);
-}
-
-static inline void DO(struct vfd_t *vfd, int value)
-{
-   if (vfd->dido_gpio_out){
-      gpiod_set_value(vfd->gpio_desc[GPIO_DIDO], value);
-   } else {
-      vfd->dido_gpio_out = 1;
-      gpiod_direction_output(vfd->gpio_desc[GPIO_DIDO], value);
-   }
-}
-
-static inline int DI(struct vfd_t *vfd)
-{
-   if (vfd->dido_gpio_out) {
-      /* switch to input mode */
-      vfd->dido_gpio_out = 0;
-      gpiod_direction_input(vfd->gpio_desc[GPIO_DIDO]);
-   }
-
-   return gpiod_get_value(vfd->gpio_desc[GPIO_DIDO]);
-}
+#include "vfd-bus.h"
 
 // Send a byte to chip; assumes STB & CLK high
 static void pt6964_send(struct vfd_t *vfd, u8 data)
@@ -71,7 +41,7 @@ static void pt6964_clear_dram(struct vfd_t *vfd)
 
    STB(vfd, 0);
    pt6964_send(vfd, CMD_ADDRESS_SET(0));
-   for (i = 0; i < RAW_DISPLAY_WORDS * 2; i++){
+   for (i = 0; i < vfd->raw_words * 2; i++){
       pt6964_send(vfd, 0);
    }
    STB(vfd, 1);
@@ -100,8 +70,21 @@ static u8 pt6964_read(struct vfd_t *vfd)
 
 /*
  * Returns the whole key state bitmap in a single 32-bit word
+ *
+ * The order of keys in key state bitmap:
+ * bit 0  - KS1+K1
+ * bit 1  - KS1+K2
+ * bit 2  - KS2+K1
+ * bit 3  - KS2+K2
+ * bit 4  - KS3+K1
+ * bit 5  - KS3+K2
+ * bit 6  - KS4+K1
+ * bit 7  - KS4+K2
+ * ...
+ * bit 18 - KS10+K1
+ * bit 19 - KS10+K2
  */
-u32 hardware_keys(struct vfd_t *vfd)
+static u32 pt6964_keys(struct vfd_t *vfd)
 {
    int i;
    u32 keys = 0;
@@ -112,45 +95,44 @@ u32 hardware_keys(struct vfd_t *vfd)
    pt6964_send(vfd, CMD_DATA_SETTING (0, 1)); /* inc = 0, read */
    udelay (1);
 
-#if defined COMPAT_FD620
-   /*
-    * The order of keys in key state bitmap:
-    * bit 0  - SEG1/KS1
-    * bit 1  - SEG2/KS2
-    * bit 2  - SEG3/KS3
-    * bit 3  - SEG4/KS4
-    * bit 4  - SEG5/KS5
-    * bit 5  - SEG6/KS6
-    * bit 6  - SEG7/KS7
-    */
-
-   for (i = 0; i < 8; i += 2) {
+   for (i = 0; i < 20; i += 4) {
       u32 x = pt6964_read (vfd);
-      x = (x & 0x01) | ((x & 8) >> 2);
+      x = (x & 0x03) | ((x & 0x18) >> 1);
       keys |= (x << i);
    }
-#else
-   /*
-    * The order of keys in key state bitmap:
-    * bit 0  - KS1+K1
-    * bit 1  - KS1+K2
-    * bit 2  - KS2+K1
-    * bit 3  - KS2+K2
-    * bit 4  - KS3+K1
-    * bit 5  - KS3+K2
-    * bit 6  - KS4+K1
-    * bit 7  - KS4+K2
-    * ...
-    * bit 18 - KS10+K1
-    * bit 19 - KS10+K2
-    */
 
-   for (i = 0; i < 20; i += 4) {
+   STB (vfd, 1);
+   udelay(1);
+
+   return keys;
+}
+
+/*
+ * Same for FD620, the order of keys in key state bitmap:
+ * bit 0  - SEG1/KS1
+ * bit 1  - SEG2/KS2
+ * bit 2  - SEG3/KS3
+ * bit 3  - SEG4/KS4
+ * bit 4  - SEG5/KS5
+ * bit 5  - SEG6/KS6
+ * bit 6  - SEG7/KS7
+ */
+static u32 fd620_keys(struct vfd_t *vfd)
+{
+   int i;
+   u32 keys = 0;
+
+   STB (vfd, 0);
+
+   // read data command
+   pt6964_send(vfd, CMD_DATA_SETTING (0, 1)); /* inc = 0, read */
+   udelay (1);
+
+   for (i = 0; i < 8; i += 2) {
       u32 x = pt6964_read (vfd);
-      x = (x & 0x03) | ((x & 18) >> 1);
+      x = (x & 0x01) | ((x & 8) >> 2);
       keys |= (x << i);
    }
-#endif
 
    STB (vfd, 1);
    udelay(1);
@@ -158,16 +140,13 @@ u32 hardware_keys(struct vfd_t *vfd)
    return keys;
 }
 
+#else
+#define pt6964_keys NULL
+#define fd620_keys NULL
 #endif
 
-void hardware_update_brightness(struct vfd_t *vfd)
+static void pt6964_set_brightness(struct vfd_t *vfd, int bri)
 {
-   int bri = ! vfd->enabled ? 0 :
-	       vfd->suspended ? vfd->brightness_suspend :
-	       vfd->brightness;
-
-   DBG_PRINT ("%d\n", bri);
-
    if (bri == 0){
       pt6964_cmd(vfd, CMD_DISPLAY_CONTROL(0, 0)); /* inc=0, write */
    } else {
@@ -175,89 +154,27 @@ void hardware_update_brightness(struct vfd_t *vfd)
    }
 }
 
-void hardware_suspend(struct vfd_t *vfd, int enable)
+// Write a run of consecutive words with auto-increment
+static void pt6964_update_range(struct vfd_t *vfd, int first, int count)
 {
-   DBG_TRACE;
-   vfd->suspended = enable;
-   hardware_update_brightness(vfd);
-}
-
-void hardware_update_display(struct vfd_t *vfd)
-{
-   unsigned i, pofs = 0x6964;
-   u16 raw [ARRAY_SIZE(vfd->raw_display)];
-
-   //DBG_TRACE;
-
-   if (vfd->display_to_raw){
-      vfd->display_to_raw (vfd, vfd->display, raw);
-   }
-
-   for (i = 0; i < ARRAY_SIZE(vfd->raw_display); i++){
-      raw [i] |= vfd->raw_overlay [i];
-   }
-
-   // update on-chip display RAM
-   for (i = 0; i < ARRAY_SIZE(vfd->raw_display); i++) {
-      u16 r = raw [i];
-
-      if (r == vfd->raw_display [i]){
-	 continue;
-      }
-
-      vfd->raw_display [i] = r;
+   int i;
 
-      if (pofs == 0x6964) {
-	 // initialize write mode with auto-increment
-	 pt6964_cmd(vfd, CMD_DATA_SETTING(1, 0)); /* inc, write */
-      } else if (pofs != (i - 1)) {
-	 // terminate previous command
-	 STB(vfd, 1);
-	 udelay(1);
-      }
+   pt6964_cmd(vfd, CMD_DATA_SETTING(1, 0)); /* inc, write */
 
-      if (pofs != (i - 1)) {
-	 STB(vfd, 0);
-	 pt6964_send(vfd, CMD_ADDRESS_SET(i * 2));
-      }
-      pofs = i;
+   STB(vfd, 0);
+   pt6964_send(vfd, CMD_ADDRESS_SET(first * 2));
+   for (i = first; i < first + count; i++) {
+      u16 r = vfd->raw_display [i];
 
       pt6964_send(vfd, r & 0xff);
       pt6964_send(vfd, r >> 8);
    }
-
-   if (pofs != 0x6964) {
-      STB(vfd, 1);
-      udelay(1);
-   }
+   STB(vfd, 1);
+   udelay(1);
 }
 
-#if defined PLATFORM_SEGNO
-// the array that maps LCD segments a,b,c,d,e,f,g to bit numbers
-static const u8 platform_segno [7] = PLATFORM_SEGNO;
-#elif defined PLATFORM_CELLNO
-// alternatively, for reverse-polarity displays
-static const u8 platform_cellno [7] = PLATFORM_CELLNO;
-static const u8 platform_cellbit [PLATFORM_DISPLAY_LEN] = PLATFORM_CELLBIT;
-#endif
-
-int hardware_init(struct vfd_t *vfd)
+static void pt6964_setup(struct vfd_t *vfd, u8 mode)
 {
-   DBG_TRACE;
-
-   vfd->display_len = PLATFORM_DISPLAY_LEN;
-   vfd->brightness = 1 + PLATFORM_BRIGHTNESS;
-   vfd->brightness_max = 1 + BRIGHTNESS_MAX;
-   vfd->brightness_suspend = 0;
-   vfd->enabled = 1;
-   vfd->dido_gpio_out = 0;
-
-#ifdef PLATFORM_SEGNO
-   vfd_init_glyphs_cc (vfd, platform_segno);
-#elif defined PLATFORM_CELLNO
-   vfd_init_glyphs_ca (vfd, platform_cellno, platform_cellbit);
-#endif
-
    // set up GPIO modes
    gpiod_direction_output(vfd->gpio_desc [GPIO_STB], 1);
    gpiod_direction_output(vfd->gpio_desc [GPIO_CLK], 1);
@@ -266,8 +183,41 @@ int hardware_init(struct vfd_t *vfd)
    udelay(10);
 
    pt6964_clear_dram(vfd);
-   pt6964_cmd(vfd, CMD_DISPLAY_MODE(PLATFORM_DISPLAY_MODE));
-   hardware_update_brightness(vfd);
+   pt6964_cmd(vfd, CMD_DISPLAY_MODE(mode));
+}
+
+static int pt6964_init(struct vfd_t *vfd)
+{
+   DBG_TRACE;
+   pt6964_setup(vfd, DISPLAY_MODE_7D10S);
+   return 0;
+}
 
+static int fd620_init(struct vfd_t *vfd)
+{
+   DBG_TRACE;
+   pt6964_setup(vfd, FD620_DISPLAY_MODE_5D7S);
    return 0;
 }
+
+const struct vfd_ops vfd_pt6964_ops = {
+   .name           = "pt6964",
+   .num_gpios      = 3,
+   .raw_words      = 7,
+   .brightness_max = 1 + BRIGHTNESS_MAX,
+   .init           = pt6964_init,
+   .update_range   = pt6964_update_range,
+   .read_keys      = pt6964_keys,
+   .set_brightness = pt6964_set_brightness,
+};
+
+const struct vfd_ops vfd_fd620_ops = {
+   .name           = "fd620",
+   .num_gpios      = 3,
+   .raw_words      = 5,
+   .brightness_max = 1 + BRIGHTNESS_MAX,
+   .init           = fd620_init,
+   .update_range   = pt6964_update_range,
+   .read_keys      = fd620_keys,
+   .set_brightness = pt6964_set_brightness,
+};
@@ -0,0 +1,10 @@
+#ifndef __VFDSIM_LINUX_DELAY_H__
+#define	__VFDSIM_LINUX_DELAY_H__
+
+#include <linux/kernel.h>
+
+/* delays are not spent but added to the modelled bus time */
+extern void ndelay(unsigned long ns);
+#define udelay(us)		ndelay ((us) * 1000UL)
+
+#endif // __VFDSIM_LINUX_DELAY_H__
@@ -0,0 +1,14 @@
+#ifndef __VFDSIM_LINUX_GPIO_CONSUMER_H__
+#define	__VFDSIM_LINUX_GPIO_CONSUMER_H__
+
+#include <linux/kernel.h>
+
+/* the pins are simulated by vfdsim.c */
+struct gpio_desc;
+
+extern void gpiod_set_value(struct gpio_desc *desc, int value);
+extern int gpiod_get_value(const struct gpio_desc *desc);
+extern int gpiod_direction_output(struct gpio_desc *desc, int value);
+extern int gpiod_direction_input(struct gpio_desc *desc);
+
+#endif // __VFDSIM_LINUX_GPIO_CONSUMER_H__
@@ -0,0 +1,32 @@
+/*
+ * Userspace stand-in for <linux/kernel.h>: just what the VFD backend,
+ * glyph and transfer code use.
+ */
+
+#ifndef __VFDSIM_LINUX_KERNEL_H__
+#define	__VFDSIM_LINUX_KERNEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#define ARRAY_SIZE(a)		(sizeof (a) / sizeof ((a) [0]))
+#define IS_REACHABLE(option)	0
+#define likely(x)		(x)
+#define unlikely(x)		(x)
+
+#define printk			printf
+
+static inline int test_bit(int nr, const unsigned long *addr)
+{
+   return (*addr >> nr) & 1;
+}
+
+#endif // __VFDSIM_LINUX_KERNEL_H__
@@ -0,0 +1,8 @@
+#ifndef __VFDSIM_LINUX_LEDS_H__
+#define	__VFDSIM_LINUX_LEDS_H__
+
+#include <linux/kernel.h>
+
+/* IS_REACHABLE(CONFIG_LEDS_CLASS) is 0, no LED class device here */
+
+#endif // __VFDSIM_LINUX_LEDS_H__
@@ -0,0 +1,10 @@
+#ifndef __VFDSIM_LINUX_MUTEX_H__
+#define	__VFDSIM_LINUX_MUTEX_H__
+
+#include <linux/kernel.h>
+
+struct mutex {
+   int unused;
+};
+
+#endif // __VFDSIM_LINUX_MUTEX_H__
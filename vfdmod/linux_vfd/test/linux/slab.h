@@ -0,0 +1,11 @@
+#ifndef __VFDSIM_LINUX_SLAB_H__
+#define	__VFDSIM_LINUX_SLAB_H__
+
+#include <stdlib.h>
+#include <linux/kernel.h>
+
+#define GFP_KERNEL		0
+#define kzalloc(size, flags)	calloc (1, size)
+#define kfree(p)		free (p)
+
+#endif // __VFDSIM_LINUX_SLAB_H__
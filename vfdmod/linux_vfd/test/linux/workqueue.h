@@ -0,0 +1,10 @@
+#ifndef __VFDSIM_LINUX_WORKQUEUE_H__
+#define	__VFDSIM_LINUX_WORKQUEUE_H__
+
+#include <linux/kernel.h>
+
+struct delayed_work {
+   int unused;
+};
+
+#endif // __VFDSIM_LINUX_WORKQUEUE_H__
@@ -0,0 +1,270 @@
+/*
+ * PT6964 and FD650 bus simulator: mock gpiod_* and ndelay for the
+ * userspace tests.
+ *
+ * The PT6964 latches DIO on the rising edge of CLK while STB is low, LSB
+ * first. The first byte of a frame is a command, the bytes following an
+ * address setting command go to display RAM. After a read data setting
+ * command the chip shifts key data out on DIO for the rest of the frame.
+ *
+ * The FD650 has no STB: a frame runs from a start condition (DIO falls
+ * while CLK is high) to a stop condition (DIO rises while CLK is high).
+ * It holds two bytes sent MSB first, each followed by an ack clock: a
+ * command and its data byte, or the read keys command and the key code
+ * the chip shifts out.
+ */
+
+#include <stdio.h>
+
+#include "vfdsim.h"
+#include "fd650.h"
+
+struct gpio_desc {
+	/* GPIO_STB, GPIO_CLK or GPIO_DIDO */
+	int index;
+	/* pin level */
+	int value;
+	/* 1 if driven by the host */
+	int out;
+};
+
+struct vfdsim_t vfdsim;
+
+static struct gpio_desc pins [GPIO_MAX];
+
+/* frame decoder state */
+static int bitno, byteno;
+static u8 shift, cmd, addr, inc, reading;
+/* FD650: DIO level latched on the rising edge of CLK, -1 after a start
+ * or stop condition, the falling edge that follows is not a bit */
+static int pending;
+
+static void vfdsim_byte (u8 b)
+{
+	vfdsim.stats.bytes++;
+
+	if (byteno++ == 0) {
+		cmd = b;
+		switch (b & 0xc0) {
+		case 0x00:
+			vfdsim.mode = b & 3;
+			break;
+		case 0x40:
+			inc = ! (b & 4);
+			reading = !! (b & 2);
+			break;
+		case 0x80:
+			vfdsim.control = b;
+			break;
+		case 0xc0:
+			addr = b & 0x0f;
+			break;
+		}
+		return;
+	}
+
+	if ((cmd & 0xc0) != 0xc0 || addr >= VFDSIM_RAM_SIZE) {
+		fprintf (stderr, "vfdsim: unexpected byte 0x%02x after command 0x%02x\n", b, cmd);
+		vfdsim.errors++;
+		return;
+	}
+	vfdsim.ram [addr] = b;
+	vfdsim.stats.ram_writes++;
+	if (inc)
+		addr++;
+}
+
+static void vfdsim_byte_2wire (u8 b)
+{
+	vfdsim.stats.bytes++;
+
+	if (byteno++ == 0) {
+		cmd = b;
+		reading = (b == FD650_CMD_READ_KEYS);
+		return;
+	}
+
+	if (byteno > 2) {
+		fprintf (stderr, "vfdsim: byte 0x%02x after the data of command 0x%02x\n", b, cmd);
+		vfdsim.errors++;
+	} else if (cmd == FD650_CMD_SYSTEM) {
+		vfdsim.control = b;
+	} else if ((cmd & ~0x06) == FD650_CMD_DIGIT (0)) {
+		// one byte per digit, the high byte of the word stays clear
+		addr = (cmd >> 1) & 3;
+		vfdsim.ram [addr * 2] = b;
+		vfdsim.ram [addr * 2 + 1] = 0;
+		vfdsim.stats.ram_writes++;
+	} else {
+		fprintf (stderr, "vfdsim: unexpected byte 0x%02x after command 0x%02x\n", b, cmd);
+		vfdsim.errors++;
+	}
+}
+
+static void vfdsim_pin_2wire (struct gpio_desc *pin, int value)
+{
+	switch (pin->index) {
+	case GPIO_DIDO:
+		if (! pins [GPIO_CLK].value)
+			break;
+		pending = -1;
+		if (! value) {
+			// start condition
+			bitno = byteno = 0;
+			shift = 0;
+			reading = 0;
+			break;
+		}
+		// stop condition
+		if (bitno != 0 || byteno != 2) {
+			fprintf (stderr, "vfdsim: frame ends after %d bytes %d bits\n", byteno, bitno);
+			vfdsim.errors++;
+		}
+		vfdsim.stats.frames++;
+		break;
+
+	case GPIO_CLK:
+		if (value) {
+			pending = pins [GPIO_DIDO].value;
+			break;
+		}
+		if (pending < 0)
+			break;
+		if (bitno++ < 8) {
+			shift = (shift << 1) | pending;
+			if (bitno == 8) {
+				// the key code comes from the chip
+				if (reading && byteno == 1)
+					byteno++;
+				else
+					vfdsim_byte_2wire (shift);
+			}
+			break;
+		}
+		// the ack clock ends the byte
+		bitno = 0;
+		shift = 0;
+		break;
+	}
+}
+
+static void vfdsim_pin (struct gpio_desc *pin, int value)
+{
+	value = !! value;
+	if (pin->value == value)
+		return;
+
+	pin->value = value;
+	vfdsim.stats.edges++;
+
+	if (vfdsim.two_wire) {
+		vfdsim_pin_2wire (pin, value);
+		return;
+	}
+
+	switch (pin->index) {
+	case GPIO_STB:
+		if (! value) {
+			bitno = byteno = 0;
+			shift = 0;
+			reading = 0;
+			break;
+		}
+		if (bitno != 0 && ! reading) {
+			fprintf (stderr, "vfdsim: frame ends after %d bits\n", bitno);
+			vfdsim.errors++;
+		}
+		vfdsim.stats.frames++;
+		break;
+
+	case GPIO_CLK:
+		if (! value || pins [GPIO_STB].value)
+			break;
+		if (reading) {
+			// the chip moves on to the next key data bit
+			bitno++;
+			break;
+		}
+		if (pins [GPIO_DIDO].out && pins [GPIO_DIDO].value)
+			shift |= 1 << bitno;
+		if (++bitno == 8) {
+			vfdsim_byte (shift);
+			bitno = 0;
+			shift = 0;
+		}
+		break;
+	}
+}
+
+void gpiod_set_value (struct gpio_desc *desc, int value)
+{
+	if (! desc->out) {
+		fprintf (stderr, "vfdsim: pin %d set while in input mode\n", desc->index);
+		vfdsim.errors++;
+	}
+	vfdsim_pin (desc, value);
+}
+
+int gpiod_get_value (const struct gpio_desc *desc)
+{
+	int n = bitno / 8;
+
+	if (vfdsim.two_wire) {
+		// the key code is shifted out MSB first
+		if (desc->index == GPIO_DIDO && reading && byteno == 1 && bitno < 8)
+			return (vfdsim.keys [0] >> (7 - bitno)) & 1;
+		return desc->value;
+	}
+	if (desc->index == GPIO_DIDO && reading && n < VFDSIM_KEY_BYTES)
+		return (vfdsim.keys [n] >> (bitno % 8)) & 1;
+	return desc->value;
+}
+
+int gpiod_direction_output (struct gpio_desc *desc, int value)
+{
+	desc->out = 1;
+	vfdsim_pin (desc, value);
+	return 0;
+}
+
+int gpiod_direction_input (struct gpio_desc *desc)
+{
+	desc->out = 0;
+	return 0;
+}
+
+void ndelay (unsigned long ns)
+{
+	vfdsim.stats.bus_ns += ns;
+}
+
+void vfdsim_attach (struct vfd_t *vfd)
+{
+	int i;
+
+	memset (&vfdsim, 0, sizeof (vfdsim));
+	memset (vfdsim.ram, 0x5a, sizeof (vfdsim.ram));
+	vfdsim.mode = 0xff;
+	vfdsim.two_wire = (vfd->ops->num_gpios == 2);
+	bitno = byteno = 0;
+	reading = 0;
+	pending = -1;
+
+	// the bus pins idle high
+	for (i = 0; i < GPIO_MAX; i++) {
+		pins [i].index = i;
+		pins [i].value = 1;
+		pins [i].out = 0;
+		vfd->gpio_desc [i] = &pins [i];
+	}
+}
+
+void vfdsim_reset_stats (void)
+{
+	memset (&vfdsim.stats, 0, sizeof (vfdsim.stats));
+}
+
+u16 vfdsim_ram_word (int n)
+{
+	return vfdsim.ram [n * 2] | (vfdsim.ram [n * 2 + 1] << 8);
+}
@@ -0,0 +1,68 @@
+/*
+ * PT6964 and FD650 bus simulator for the userspace tests of the VFD driver.
+ *
+ * The mock gpiod_* calls drive three simulated pins, two for the FD650. Every pin
+ * transition is recorded and decoded back into chip commands and
+ * display RAM contents, and ndelay/udelay add to the modelled bus time.
+ */
+
+#ifndef __VFDSIM_H__
+#define	__VFDSIM_H__
+
+#include "vfd-priv.h"
+
+// PT6964 display RAM: 7 words of 2 bytes
+#define VFDSIM_RAM_SIZE			14
+// key scan data bytes shifted out by the chip
+#define VFDSIM_KEY_BYTES		5
+
+struct vfdsim_stats_t {
+	/* pin transitions */
+	unsigned long edges;
+	/* modelled bus time in nanoseconds */
+	unsigned long bus_ns;
+	/* STB low..high frames */
+	unsigned long frames;
+	/* bytes clocked into the chip */
+	unsigned long bytes;
+	/* display RAM bytes written */
+	unsigned long ram_writes;
+};
+
+struct vfdsim_t {
+	struct vfdsim_stats_t stats;
+	/* number of protocol errors seen */
+	int errors;
+	/* 1 to decode the FD650 2-wire bus, set from the backend attached */
+	int two_wire;
+
+	/* decoded chip state */
+	u8 ram [VFDSIM_RAM_SIZE];
+	/* last display mode set, 0xff if none or FD650 */
+	u8 mode;
+	/* last display control command (FD650: its data byte), 0 if none */
+	u8 control;
+	/* key scan data returned by the next read command, FD650: key code in keys [0] */
+	u8 keys [VFDSIM_KEY_BYTES];
+};
+
+extern struct vfdsim_t vfdsim;
+
+/*
+ * Connect vfd->gpio_desc[] to the simulated pins and reset the chip
+ * state, the display RAM is filled with garbage. vfd->ops tells which
+ * bus to decode.
+ */
+extern void vfdsim_attach (struct vfd_t *vfd);
+
+/*
+ * Clear the counters before a measured operation.
+ */
+extern void vfdsim_reset_stats (void);
+
+/*
+ * Display RAM word n as the driver stores it in vfd->raw_display[n].
+ */
+extern u16 vfdsim_ram_word (int n);
+
+#endif // __VFDSIM_H__
@@ -0,0 +1,357 @@
+/*
+ * Userspace tests of the VFD driver transfer and glyph code.
+ *
+ * The backend, glyph and update code is built unchanged against the
+ * bus simulator. Every check compares the display RAM decoded from the
+ * pin transitions with what the driver meant to send, and the cost of
+ * each hardware_update_display() call is printed for benchmarking.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <linux/slab.h>
+
+#include "vfd-board.h"
+#include "pt6964.h"
+#include "fd650.h"
+#include "vfdsim.h"
+
+static int checks, failures;
+
+#define CHECK(cond) do { \
+	checks++; \
+	if (! (cond)) { \
+		failures++; \
+		printf ("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+	} \
+} while (0)
+
+// expected glyph image of a character with an identity segment mapping
+static u16 glyph_image (char code)
+{
+	int i;
+
+	for (i = 0; vfd_glyphs [i].code != 0; i++)
+		if (vfd_glyphs [i].code == code)
+			return vfd_glyphs [i].image;
+	return 0;
+}
+
+static struct vfd_t *vfdtest_new (const struct vfd_board *board)
+{
+	struct vfd_t *vfd = kzalloc (sizeof (struct vfd_t), GFP_KERNEL);
+
+	vfd->board = board;
+	vfd->ops = board->ops;
+	vfdsim_attach (vfd);
+	if (hardware_init (vfd) != 0) {
+		printf ("%s: hardware_init failed\n", board->name);
+		exit (1);
+	}
+	return vfd;
+}
+
+static void vfdtest_free (struct vfd_t *vfd)
+{
+	kfree (vfd->glyph_render_data);
+	kfree (vfd);
+}
+
+// the display RAM decoded from the bus holds what the driver sent
+static void vfdtest_check_ram (struct vfd_t *vfd)
+{
+	int i;
+
+	for (i = 0; i < vfd->raw_words; i++)
+		CHECK (vfdsim_ram_word (i) == vfd->raw_display [i]);
+	CHECK (vfdsim.errors == 0);
+}
+
+static void vfdtest_update (struct vfd_t *vfd, const char *what)
+{
+	vfdsim_reset_stats ();
+	hardware_update_display (vfd);
+
+	printf ("  %-8s %-28s %4lu edges %8.1f us %3lu bytes %2lu frames\n",
+		vfd->ops->name, what, vfdsim.stats.edges,
+		vfdsim.stats.bus_ns / 1000.0, vfdsim.stats.bytes,
+		vfdsim.stats.frames);
+
+	vfdtest_check_ram (vfd);
+}
+
+static void vfdtest_display (struct vfd_t *vfd, const char *text)
+{
+	memset (vfd->display, 0, sizeof (vfd->display));
+	memcpy (vfd->display, text, strlen (text));
+}
+
+static void test_init (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+	int i;
+
+	CHECK (vfd->raw_words == 5);
+	CHECK (vfdsim.mode == FD620_DISPLAY_MODE_5D7S);
+	CHECK (vfdsim.control == CMD_DISPLAY_CONTROL (1, vfd->board->brightness));
+	for (i = 0; i < vfd->raw_words * 2; i++)
+		CHECK (vfdsim.ram [i] == 0);
+	CHECK (vfdsim.errors == 0);
+
+	vfdtest_free (vfd);
+}
+
+static void test_update (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+	int i;
+
+	vfdtest_display (vfd, "1234");
+	vfdtest_update (vfd, "4 digits");
+	for (i = 0; i < 4; i++)
+		CHECK (vfd->raw_display [i] == glyph_image ("1234" [i]));
+
+	vfdtest_update (vfd, "no change");
+	CHECK (vfdsim.stats.edges == 0);
+
+	// one data setting frame, then the address and one word
+	vfd->display [2] = '7';
+	vfdtest_update (vfd, "1 digit");
+	CHECK (vfdsim.stats.frames == 2);
+	CHECK (vfdsim.stats.ram_writes == 2);
+	CHECK (vfd->raw_display [2] == glyph_image ('7'));
+
+	// words 0 and 3 changed, sent as two runs
+	vfdtest_display (vfd, "9279");
+	vfdtest_update (vfd, "2 digits apart");
+	CHECK (vfdsim.stats.frames == 4);
+	CHECK (vfdsim.stats.ram_writes == 4);
+
+	vfdtest_display (vfd, "----");
+	vfd->raw_overlay [4] = 0x0004;
+	vfdtest_update (vfd, "all digits and overlay");
+	CHECK (vfdsim.stats.ram_writes == 10);
+	CHECK (vfdsim_ram_word (4) == 0x0004);
+
+	vfdtest_free (vfd);
+}
+
+// a text animation frame hides the text, which shows again once it stops
+static void test_anim_text (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+	int i;
+
+	vfdtest_display (vfd, "1234");
+	vfdtest_update (vfd, "text");
+
+	memset (vfd->anim_text, 0, sizeof (vfd->anim_text));
+	memcpy (vfd->anim_text, "b00t", 4);
+	vfd->anim_text_on = 1;
+	vfdtest_update (vfd, "anim text frame");
+	for (i = 0; i < 4; i++)
+		CHECK (vfd->raw_display [i] == glyph_image ("b00t" [i]));
+	CHECK (memcmp (vfd->display, "1234", 4) == 0);
+
+	vfd->anim_text_on = 0;
+	vfdtest_update (vfd, "anim stopped");
+	for (i = 0; i < 4; i++)
+		CHECK (vfd->raw_display [i] == glyph_image ("1234" [i]));
+	vfdtest_check_ram (vfd);
+
+	vfdtest_free (vfd);
+}
+
+static void test_dotleds (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+	struct vfd_dotled_t dotleds [2] = {
+		{ .name = "usb", .word = 4, .bit = 1 },
+		{ .name = "net", .word = 4, .bit = 5 },
+	};
+
+	vfd->dotleds = dotleds;
+	vfd->num_dotleds = 2;
+	vfd->raw_overlay [4] = 0x0004;
+	vfd->led_state = 2;
+	vfdtest_update (vfd, "LED trigger bit");
+	CHECK (vfdsim_ram_word (4) == 0x0024);
+
+	vfdtest_free (vfd);
+}
+
+static void test_grid_num (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_pt6964);
+	u8 grid [] = { 3, 2, 1, 0 };
+
+	CHECK (vfd->raw_words == 7);
+	CHECK (vfdsim.mode == DISPLAY_MODE_7D10S);
+
+	vfd->grid_len = sizeof (grid);
+	memcpy (vfd->grid_num, grid, sizeof (grid));
+	vfdtest_display (vfd, "1234");
+	vfdtest_update (vfd, "reversed grid");
+	CHECK (vfd->raw_display [0] == glyph_image ('4'));
+	CHECK (vfd->raw_display [3] == glyph_image ('1'));
+
+	vfdtest_free (vfd);
+}
+
+static void test_glyphs_load (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+	u16 image = 0x1234;
+
+	CHECK (vfd->glyphs_load != NULL);
+	CHECK (vfd->glyphs_load (vfd, '0' - VFD_GLYPHS_FIRST, &image, 1) == 0);
+	CHECK (vfd->glyphs_load (vfd, VFD_GLYPHS_COUNT - 1, &image, 2) == -EINVAL);
+
+	vfdtest_display (vfd, "0 0");
+	vfdtest_update (vfd, "uploaded glyph");
+	CHECK (vfd->raw_display [0] == 0x1234);
+	CHECK (vfd->raw_display [1] == 0);
+	CHECK (vfd->raw_display [2] == 0x1234);
+
+	vfdtest_free (vfd);
+}
+
+static void test_common_anode (void)
+{
+	// the board picks the common anode renderer
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_x92);
+	int i;
+
+	CHECK (vfd->ops == &vfd_pt6964_ops);
+	CHECK (vfd->glyphs_load == NULL);
+
+	// '1' lights segments b and c of the first cell
+	vfdtest_display (vfd, "1   ");
+	vfdtest_update (vfd, "common anode");
+	for (i = 0; i < 7; i++)
+		CHECK (vfd->raw_display [i] == ((i == 1 || i == 2) ? 0x80 : 0));
+
+	vfdtest_display (vfd, "8888");
+	vfdtest_update (vfd, "common anode all cells");
+	for (i = 0; i < 7; i++)
+		CHECK (vfd->raw_display [i] == 0xf0);
+
+	vfdtest_free (vfd);
+}
+
+static void test_brightness (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+
+	vfd->brightness = vfd->brightness_max;
+	hardware_update_brightness (vfd);
+	CHECK (vfdsim.control == CMD_DISPLAY_CONTROL (1, BRIGHTNESS_MAX));
+
+	vfd->enabled = 0;
+	hardware_update_brightness (vfd);
+	CHECK (vfdsim.control == CMD_DISPLAY_CONTROL (0, 0));
+
+	vfd->enabled = 1;
+	vfd->brightness_suspend = 1;
+	hardware_suspend (vfd, 1);
+	CHECK (vfdsim.control == CMD_DISPLAY_CONTROL (1, 0));
+	CHECK (vfdsim.errors == 0);
+
+	vfdtest_free (vfd);
+}
+
+static void test_keys (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_t95u);
+
+	// SEG1/KS1 in the first byte, SEG4/KS4 in the second one
+	vfdsim.keys [0] = 0x01;
+	vfdsim.keys [1] = 0x08;
+	CHECK (hardware_keys (vfd) == 0x09);
+
+	vfd->ops = &vfd_pt6964_ops;
+	memset (vfdsim.keys, 0, sizeof (vfdsim.keys));
+	// KS1+K1 and KS3+K2
+	vfdsim.keys [0] = 0x01;
+	vfdsim.keys [1] = 0x02;
+	CHECK (hardware_keys (vfd) == 0x21);
+	CHECK (vfdsim.errors == 0);
+
+	// display writes still work after the DI/DO pin was read
+	vfdtest_display (vfd, "8");
+	vfdtest_update (vfd, "update after key scan");
+
+	vfdtest_free (vfd);
+}
+
+static void test_fd650 (void)
+{
+	struct vfd_t *vfd = vfdtest_new (&vfd_board_fd650);
+	int i;
+
+	CHECK (vfd->raw_words == FD650_DIGITS);
+	CHECK (vfdsim.control == FD650_CONTROL (vfd->brightness));
+	CHECK (vfd->glyphs_load != NULL);
+	vfdtest_check_ram (vfd);
+
+	vfdtest_display (vfd, "1234");
+	vfdtest_update (vfd, "4 digits");
+	for (i = 0; i < 4; i++)
+		CHECK (vfd->raw_display [i] == glyph_image ("1234" [i]));
+	// one command of 2 bytes per digit
+	CHECK (vfdsim.stats.frames == 4);
+	CHECK (vfdsim.stats.bytes == 8);
+
+	vfd->display [1] = '7';
+	vfdtest_update (vfd, "1 digit");
+	CHECK (vfdsim.stats.frames == 1);
+	CHECK (vfdsim.stats.ram_writes == 1);
+
+	vfd->enabled = 0;
+	hardware_update_brightness (vfd);
+	CHECK (vfdsim.control == FD650_CONTROL_OFF);
+	vfd->enabled = 1;
+	hardware_update_brightness (vfd);
+	CHECK (vfdsim.control == FD650_CONTROL (vfd->brightness));
+
+	// KI3 on DIG2 held down, then released
+	vfdsim.keys [0] = FD650_KEY_DOWN | (1 << 3) | 2;
+	CHECK (hardware_keys (vfd) == 1U << (1 * 4 + 2));
+	vfdsim.keys [0] = 0;
+	CHECK (hardware_keys (vfd) == 0);
+	CHECK (vfdsim.errors == 0);
+
+	// display writes still work after the key code was read
+	vfdtest_display (vfd, "8888");
+	vfdtest_update (vfd, "update after key read");
+
+	vfdtest_free (vfd);
+}
+
+static void test_board_find (void)
+{
+	CHECK (vfd_board_find ("x92") == &vfd_board_x92);
+	CHECK (vfd_board_find ("fd650") == &vfd_board_fd650);
+	CHECK (vfd_board_find ("x93") == NULL);
+	CHECK (vfd_board_t95u.segno != NULL);
+	CHECK (vfd_board_x92.segno == NULL);
+}
+
+int main (void)
+{
+	test_init ();
+	test_update ();
+	test_anim_text ();
+	test_dotleds ();
+	test_grid_num ();
+	test_glyphs_load ();
+	test_common_anode ();
+	test_brightness ();
+	test_keys ();
+	test_fd650 ();
+	test_board_find ();
+
+	printf ("%d checks, %d failed\n", checks, failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Display-to-IC connection schemes of the supported boards.
+ * Copyright (c) 2017 Andrew Zabolotny <zapparello@ya.ru>
+ *
+ * A board ties a driver IC backend to the way the LED display is
+ * wired to it, which selects the glyph renderer: vfd-cc.c for
+ * common-cathode displays, vfd-ca.c for common-anode ones. All the
+ * boards are in the module, the device tree chooses one at probe.
+ */
+
+#include <linux/kernel.h>
+
+#include "vfd-board.h"
+
+// LED display brightness at startup
+#define BOARD_BRIGHTNESS		3
+// Number of displayed glyphs
+#define BOARD_DISPLAY_LEN		4
+
+// (see vfd-glyphs.c) a|b|c|d|e|f|g -> cell bit number (0-15) translation table
+static const u8 segno_abcdefg [7] = { 0, 1, 2, 3, 4, 5, 6 };
+
+#ifdef CONFIG_VFD_PT6964
+
+// X92 uses a common-ANODE LED display, so the display RAM
+// is organized quite perversely.
+
+// (see vfd7s.c) a|b|c|d|e|f|g -> display grid number
+static const u8 x92_cellno [7] = { 0, 1, 2, 3, 4, 5, 6 };
+// Bit number to set, depending on display cell
+static const u8 x92_cellbit [BOARD_DISPLAY_LEN] = { 7, 6, 5, 4 };
+
+const struct vfd_board vfd_board_pt6964 = {
+   .name        = "pt6964",
+   .ops         = &vfd_pt6964_ops,
+   .brightness  = BOARD_BRIGHTNESS,
+   .display_len = BOARD_DISPLAY_LEN,
+   .segno       = segno_abcdefg,
+};
+
+const struct vfd_board vfd_board_fd620 = {
+   .name        = "fd620",
+   .ops         = &vfd_fd620_ops,
+   .brightness  = BOARD_BRIGHTNESS,
+   .display_len = BOARD_DISPLAY_LEN,
+   .segno       = segno_abcdefg,
+};
+
+const struct vfd_board vfd_board_x92 = {
+   .name        = "x92",
+   .ops         = &vfd_pt6964_ops,
+   .brightness  = BOARD_BRIGHTNESS,
+   .display_len = BOARD_DISPLAY_LEN,
+   .cellno      = x92_cellno,
+   .cellbit     = x92_cellbit,
+};
+
+const struct vfd_board vfd_board_t95u = {
+   .name        = "t95u",
+   .ops         = &vfd_fd620_ops,
+   .brightness  = BOARD_BRIGHTNESS,
+   .display_len = BOARD_DISPLAY_LEN,
+   .segno       = segno_abcdefg,
+};
+
+#endif
+
+#ifdef CONFIG_VFD_FD650
+
+const struct vfd_board vfd_board_fd650 = {
+   .name        = "fd650",
+   .ops         = &vfd_fd650_ops,
+   .brightness  = BOARD_BRIGHTNESS,
+   .display_len = BOARD_DISPLAY_LEN,
+   .segno       = segno_abcdefg,
+};
+
+#endif
+
+static const struct vfd_board *vfd_boards [] = {
+#ifdef CONFIG_VFD_PT6964
+   &vfd_board_pt6964,
+   &vfd_board_fd620,
+   &vfd_board_x92,
+   &vfd_board_t95u,
+#endif
+#ifdef CONFIG_VFD_FD650
+   &vfd_board_fd650,
+#endif
+   NULL
+};
+
+const struct vfd_board *vfd_board_find (const char *name)
+{
+   int i;
+
+   for (i = 0; vfd_boards [i]; i++){
+      if (strcmp (vfd_boards [i]->name, name) == 0){
+	 return vfd_boards [i];
+      }
+   }
+   return NULL;
+}
@@ -0,0 +1,33 @@
+/*
+ * Display-to-IC connection schemes of the supported boards.
+ * Copyright (c) 2017 Andrew Zabolotny <zapparello@ya.ru>
+ */
+
+#ifndef __VFD_BOARD_H__
+#define	__VFD_BOARD_H__
+
+#include "vfd-priv.h"
+
+#ifdef CONFIG_VFD_PT6964
+// PT6964, TM1628, FD628 with a common-cathode display
+extern const struct vfd_board vfd_board_pt6964;
+// FD620 with a common-cathode display
+extern const struct vfd_board vfd_board_fd620;
+// X92 AMlogic S912-based TV box: FD628, common-anode display
+extern const struct vfd_board vfd_board_x92;
+// T95U AMlogic S912-based TV box: FD620, common-cathode display
+extern const struct vfd_board vfd_board_t95u;
+#endif
+
+#ifdef CONFIG_VFD_FD650
+// FD650, TM1650 with a common-cathode display
+extern const struct vfd_board vfd_board_fd650;
+#endif
+
+/*
+ * Returns the board named by the "board" device tree property,
+ * NULL if there is none or its backend is not built in.
+ */
+extern const struct vfd_board *vfd_board_find (const char *name);
+
+#endif // __VFD_BOARD_H__
@@ -0,0 +1,44 @@
+/*
+ * Bit-banged bus signals shared by the chip backends.
+ * Copyright (c) 2017 Andrew Zabolotny <zapparello@ya.ru>
+ */
+
+#ifndef __VFD_BUS_H__
+#define	__VFD_BUS_H__
+
+#include <linux/gpio/consumer.h>
+
+#include "vfd-priv.h"
+
+static inline void CLK(struct vfd_t *vfd, int value)
+{
+   gpiod_set_value(vfd->gpio_desc[GPIO_CLK], value);
+}
+
+static inline void STB(struct vfd_t *vfd, int value)
+{
+   gpiod_set_value(vfd->gpio_desc[GPIO_STB], value);
+}
+
+static inline void DO(struct vfd_t *vfd, int value)
+{
+   if (vfd->dido_gpio_out){
+      gpiod_set_value(vfd->gpio_desc[GPIO_DIDO], value);
+   } else {
+      vfd->dido_gpio_out = 1;
+      gpiod_direction_output(vfd->gpio_desc[GPIO_DIDO], value);
+   }
+}
+
+static inline int DI(struct vfd_t *vfd)
+{
+   if (vfd->dido_gpio_out) {
+      /* switch to input mode */
+      vfd->dido_gpio_out = 0;
+      gpiod_direction_input(vfd->gpio_desc[GPIO_DIDO]);
+   }
+
+   return gpiod_get_value(vfd->gpio_desc[GPIO_DIDO]);
+}
+
+#endif // __VFD_BUS_H__
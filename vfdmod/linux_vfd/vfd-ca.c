@@ -48,6 +48,8 @@ void vfd_init_glyphs_ca (struct vfd_t *vfd, const u8 *cellno, const u8 *cellbit)
 	u8 code;
 	struct vfd_glyph_render_t *g = kzalloc (sizeof (struct vfd_glyph_render_t), GFP_KERNEL);
 	vfd->display_to_raw = vfd_display_to_raw_ca;
+	/* a glyph spans several words, there is no table to load */
+	vfd->glyphs_load = NULL;
 	vfd->glyph_render_data = g;
 	g->cellno = cellno;
 	g->cellbit = cellbit;
@@ -17,7 +17,7 @@
 #include "vfd-priv.h"
 
 struct vfd_glyph_render_t {
-   u16 cellcode ['~' - ' ' + 1];
+   u16 cellcode [VFD_GLYPHS_COUNT];
 };
 
 /* Convert a string of 8-bit characters into a string of 16-bit
@@ -44,6 +44,18 @@ static void vfd_display_to_raw_cc (struct vfd_t *vfd, u8 *display, u16 *raw)
    }
 }
 
+/* Replace glyph images by the ones uploaded from userspace */
+static int vfd_glyphs_load_cc (struct vfd_t *vfd, int first, const u16 *image, int count)
+{
+   struct vfd_glyph_render_t *g = (struct vfd_glyph_render_t *) vfd->glyph_render_data;
+
+   if (first < 0 || first + count > ARRAY_SIZE (g->cellcode)){
+      return -EINVAL;
+   }
+   memcpy (g->cellcode + first, image, count * sizeof (u16));
+   return 0;
+}
+
 /* Initialize glyph images for current platform from the
  * platform-independent representation */
 void vfd_init_glyphs_cc (struct vfd_t *vfd, const u8 *segno)
@@ -54,6 +66,7 @@ void vfd_init_glyphs_cc (struct vfd_t *vfd, const u8 *segno)
 
    vfd->glyph_render_data = g;
    vfd->display_to_raw = vfd_display_to_raw_cc;
+   vfd->glyphs_load = vfd_glyphs_load_cc;
 
    if ( vfd->segment_len ){
       segno = vfd->segment_no;
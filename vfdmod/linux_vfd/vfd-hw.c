@@ -0,0 +1,113 @@
+/*
+ * Chip independent part of the VFD backend: everything goes through
+ * the vfd->ops of the display driver IC found in the device tree.
+ * Copyright (c) 2017 Andrew Zabolotny <zapparello@ya.ru>
+ */
+
+#include <linux/kernel.h>
+
+#include "vfd-board.h"
+
+#ifndef CONFIG_VFD_NO_KEY_INPUT
+
+u32 hardware_keys(struct vfd_t *vfd)
+{
+   if ( ! vfd->ops->read_keys){
+      return 0;
+   }
+   return vfd->ops->read_keys(vfd);
+}
+
+#endif
+
+void hardware_update_brightness(struct vfd_t *vfd)
+{
+   int bri = ! vfd->enabled ? 0 :
+	       vfd->suspended ? vfd->brightness_suspend :
+	       vfd->brightness;
+
+   DBG_PRINT ("%d\n", bri);
+
+   vfd->ops->set_brightness(vfd, bri);
+}
+
+void hardware_suspend(struct vfd_t *vfd, int enable)
+{
+   DBG_TRACE;
+   vfd->suspended = enable;
+   hardware_update_brightness(vfd);
+}
+
+void hardware_update_display(struct vfd_t *vfd)
+{
+   int i, first = -1;
+   u16 raw [RAW_DISPLAY_WORDS];
+
+   //DBG_TRACE;
+
+   // a text animation frame hides the text, it shows again at the end
+   if (vfd->display_to_raw){
+      vfd->display_to_raw (vfd, vfd->anim_text_on ? vfd->anim_text : vfd->display, raw);
+   } else {
+      memset (raw, 0, sizeof (raw));
+   }
+
+   // a raw animation frame replaces the overlay words it holds
+   for (i = 0; i < vfd->raw_words; i++){
+      raw [i] |= (i < vfd->anim_raw_len) ? vfd->anim_raw [i] : vfd->raw_overlay [i];
+   }
+
+   // dot LEDs driven by the kernel LED triggers
+   for (i = 0; vfd->led_state && i < vfd->num_dotleds; i++){
+      if (test_bit(i, &vfd->led_state)){
+	 raw [vfd->dotleds [i].word] |= (1 << vfd->dotleds [i].bit);
+      }
+   }
+
+   // update on-chip display RAM, one transfer per run of changed words
+   for (i = 0; i <= vfd->raw_words; i++) {
+      if (i < vfd->raw_words && raw [i] != vfd->raw_display [i]) {
+	 vfd->raw_display [i] = raw [i];
+	 if (first < 0){
+	    first = i;
+	 }
+	 continue;
+      }
+      if (first >= 0) {
+	 vfd->ops->update_range(vfd, first, i - first);
+	 first = -1;
+      }
+   }
+}
+
+int hardware_init(struct vfd_t *vfd)
+{
+   int ret;
+
+   DBG_TRACE;
+
+   vfd->raw_words = vfd->ops->raw_words;
+   vfd->display_len = vfd->board->display_len;
+   if (vfd->display_len > vfd->raw_words){
+      vfd->display_len = vfd->raw_words;
+   }
+   vfd->brightness = 1 + vfd->board->brightness;
+   vfd->brightness_max = vfd->ops->brightness_max;
+   vfd->brightness_suspend = 0;
+   vfd->enabled = 1;
+   vfd->dido_gpio_out = 0;
+
+   // the renderer follows the wiring of the board
+   if (vfd->board->segno){
+      vfd_init_glyphs_cc (vfd, vfd->board->segno);
+   } else {
+      vfd_init_glyphs_ca (vfd, vfd->board->cellno, vfd->board->cellbit);
+   }
+
+   if ((ret = vfd->ops->init(vfd)) != 0){
+      return ret;
+   }
+   hardware_update_brightness(vfd);
+
+   return 0;
+}
@@ -5,9 +5,10 @@
 #ifndef __VFD_PRIV_H__
 #define __VFD_PRIV_H__
 
-#include <linux/timer.h>
+#include <linux/workqueue.h>
 #include <linux/mutex.h>
 #include <linux/delay.h>
+#include <linux/leds.h>
 
 #ifdef CONFIG_HAS_EARLYSUSPEND
 #include <linux/earlysuspend.h>
@@ -29,19 +30,8 @@
 #define DBG_TRACE
 #endif
 
-#if defined CONFIG_VFD_PT6964_T95U
-#  define COMPAT_FD620
-#else
-#  define COMPAT_PT6964
-#endif
-
-#if defined COMPAT_FD620
-// 5 16-bit words of display RAM
-#define RAW_DISPLAY_WORDS		5
-#else
-// 7 16-bit words of display RAM
+// up to 7 16-bit words of display RAM, the chip backend tells how many are used
 #define RAW_DISPLAY_WORDS		7
-#endif
 
 struct vfd_key_t {
 	/* linux key code */
@@ -50,6 +40,22 @@ struct vfd_key_t {
 	u16 scancode;
 };
 
+// size of the animation frame table
+#define VFD_ANIM_FRAMES			32
+
+struct vfd_frame_t {
+	/* time to show this frame in milliseconds */
+	u16 duration;
+	/* 1 if the frame holds overlay words, 0 if it holds characters */
+	u8 is_raw;
+	/* number of characters or words used */
+	u8 len;
+	union {
+		char text [RAW_DISPLAY_WORDS];
+		u16 raw [RAW_DISPLAY_WORDS];
+	};
+};
+
 struct vfd_dotled_t {
 	/* LED name */
 	const char *name;
@@ -57,6 +63,12 @@ struct vfd_dotled_t {
 	u16 word;
 	/* bit number within the word */
 	u16 bit;
+#if IS_REACHABLE(CONFIG_LEDS_CLASS)
+	/* the LED class device, cdev.name is NULL if not registered */
+	struct led_classdev cdev;
+	/* back pointer for the LED callbacks */
+	struct vfd_t *vfd;
+#endif
 };
 
 enum
@@ -72,12 +84,79 @@ enum
 	GPIO_MAX
 };
 
+struct vfd_t;
+
+/*
+ * Display driver IC backend, the one of the board (struct vfd_board)
+ */
+struct vfd_ops {
+	/* chip name */
+	const char *name;
+	/* number of bus GPIOs used, taken from the end of the gpio_xxx[] arrays */
+	int num_gpios;
+	/* number of 16-bit words of display RAM */
+	int raw_words;
+	/* number of brightness levels, level 0 is off */
+	u8 brightness_max;
+
+	/*
+	 * Initialize the chip. Returns 0 or -errno.
+	 */
+	int (*init) (struct vfd_t *vfd);
+	/*
+	 * Send words first..first+count-1 of vfd->raw_display to display RAM
+	 */
+	void (*update_range) (struct vfd_t *vfd, int first, int count);
+	/*
+	 * Returns key pressed bitmap, may be NULL if the chip has no keys
+	 */
+	u32 (*read_keys) (struct vfd_t *vfd);
+	/*
+	 * Set brightness level 0 (display off) to brightness_max
+	 */
+	void (*set_brightness) (struct vfd_t *vfd, int level);
+};
+
+/* PT6964, SM1628, TM1623, TM1628, FD628 */
+extern const struct vfd_ops vfd_pt6964_ops;
+/* FD620 */
+extern const struct vfd_ops vfd_fd620_ops;
+/* FD650, TM1650 : 2-wire bus */
+extern const struct vfd_ops vfd_fd650_ops;
+
+/*
+ * Wiring of a board's LED display to its driver IC, selected by the
+ * device tree compatible string or "board" property (see vfd-board.c)
+ */
+struct vfd_board {
+	/* board name, as given in the "board" property */
+	const char *name;
+	/* the display driver IC backend */
+	const struct vfd_ops *ops;
+	/* LED display brightness at startup */
+	u8 brightness;
+	/* number of displayed glyphs */
+	int display_len;
+	/* common cathode: segments a..g -> cell bit number */
+	const u8 *segno;
+	/* common anode, if segno is NULL: segments a..g -> display grid
+	 * number, and the bit of each display cell */
+	const u8 *cellno;
+	const u8 *cellbit;
+};
+
 struct vfd_t {
 	/* the global device lock */
 	struct mutex lock;
 
+	/* the board wiring and its display driver IC backend */
+	const struct vfd_board *board;
+	const struct vfd_ops *ops;
+
 	struct input_dev *input;
-	struct timer_list timer;
+	/* key scan, display refresh, fade and animation steps, in process
+	 * context so they can take the lock like the sysfs handlers */
+	struct delayed_work refresh;
 
 	/* bus gpio pin descriptors */
 	struct gpio_desc *gpio_desc [GPIO_MAX];
@@ -101,6 +180,8 @@ struct vfd_t {
 	u16 raw_overlay [RAW_DISPLAY_WORDS];
 	/* The raw display content (device-dependent format) */
 	u16 raw_display [RAW_DISPLAY_WORDS];
+	/* Number of raw words used by the chip */
+	int raw_words;
 	/* The cathodet order and lenght */
         int grid_len;
 	u8 grid_num [RAW_DISPLAY_WORDS];
@@ -118,6 +199,15 @@ struct vfd_t {
 	 *      the array to receive glyph bitmap data
 	 */
 	void (*display_to_raw) (struct vfd_t *vfd, u8 *display, u16 *raw);
+	/*
+	 * Replace glyph images loaded from userspace, NULL if the glyph
+	 * renderer has no loadable glyph table
+	 * @param first
+	 *      first character to replace, 0 is VFD_GLYPHS_FIRST
+	 * @param image
+	 *      count 16-bit display bitmasks
+	 */
+	int (*glyphs_load) (struct vfd_t *vfd, int first, const u16 *image, int count);
 	/* glyph renderer private data */
 	void *glyph_render_data;
 
@@ -127,21 +217,46 @@ struct vfd_t {
 	u8 brightness_max;
 	/* Brightness in suspend mode */
 	u8 brightness_suspend;
+	/* Brightness fade: level at fade start and target level */
+	u8 fade_from;
+	u8 fade_to;
+	/* Fade start time and length in jiffies, fade_len is 0 if no fade runs */
+	unsigned long fade_start;
+	unsigned long fade_len;
 	/* Display enabled (1) or disabled (0) */
 	u8 enabled;
 	/* Operating system suspended (1) or resumed (0) */
 	u8 suspended;
 	/* Set to 1 if any variables affecting display have changed */
 	u8 need_update;
-	/* Boot animation stage */
-	u8 boot_anim;
+	/* Animation frames, played back by the refresh work: a table the
+	 * passes run over again, frames are only dropped by clear */
+	struct vfd_frame_t anim [VFD_ANIM_FRAMES];
+	/* number of frames in anim, 0 if no animation runs */
+	int anim_count;
+	/* overlay words of the current raw frame, shown instead of the
+	 * first anim_raw_len words of raw_overlay while it plays */
+	u16 anim_raw [RAW_DISPLAY_WORDS];
+	int anim_raw_len;
+	/* characters of the current text frame, shown instead of display
+	 * while anim_text_on is set : display keeps the text of sysfs */
+	char anim_text [RAW_DISPLAY_WORDS];
+	int anim_text_on;
+	/* next frame to show */
+	int anim_pos;
+	/* remaining passes over the frames, 0 loops forever */
+	int anim_loops;
+	/* time (jiffies) to show the next frame */
+	unsigned long anim_next;
 	/* the state of up to 20 keys */
 	u32 keystate;
 
-	/* number of elements in the dotleds array */
+	/* number of elements in the dotleds array, at most BITS_PER_LONG */
 	int num_dotleds;
 	/* dot LEDs descriptions */
 	struct vfd_dotled_t *dotleds;
+	/* dot LEDs lit through the LED class (bit n for dotleds[n]) */
+	unsigned long led_state;
 
 #ifdef CONFIG_HAS_EARLYSUSPEND
 	/* early suspend structure */
@@ -155,10 +270,11 @@ extern int get_vfd_key_value (void);
 extern int set_vfd_led_value (char *display_code);
 extern void Led_Show_lockflg (bool lockflg);
 
-/* These functions must be provided by the backend */
+/* These functions are provided by vfd-hw.c on top of vfd->ops */
 
 /*
- * Initialize the backend. Returns 0 or -errno.
+ * Initialize the backend and the glyph renderer of vfd->board.
+ * Returns 0 or -errno.
  */
 extern int hardware_init (struct vfd_t *vfd);
 
@@ -198,6 +314,10 @@ extern void hardware_suspend(struct vfd_t *vfd, int enable);
 extern void hardware_update_display(struct vfd_t *vfd);
 
 
+// characters with a glyph image, the glyphs attribute holds one u16 per character
+#define VFD_GLYPHS_FIRST		' '
+#define VFD_GLYPHS_COUNT		('~' - ' ' + 1)
+
 struct vfd_glyph_t {
 	char code;
 	u8 image;
@@ -35,19 +35,25 @@
 #include <linux/of.h>
 #include <linux/of_address.h>
 #include <linux/of_gpio.h>
+#include <linux/of_device.h>
 #include <asm/irq.h>
 #include <asm/io.h>
 
 #include <linux/major.h>
 #include <linux/slab.h>
+#include <linux/workqueue.h>
 #include <asm/uaccess.h>
 
 #include "vfd-priv.h"
+#include "vfd-board.h"
 
 #ifdef CONFIG_HAS_EARLYSUSPEND
 static void vfd_early_suspend (struct early_suspend *h);
 #endif
 
+/* Length of the fade-in when the display comes back from suspend */
+#define VFD_RESUME_FADE_MS	500
+
 static const char *skip_nspaces (const char *str, int *count)
 {
    while (*count && isspace (*str)) {
@@ -57,6 +63,47 @@ static const char *skip_nspaces (const char *str, int *count)
    return str;
 }
 
+//***//***//***//***//***//***// brightness fade //***//***//***//***//***//***//
+
+/*
+ * Start fading from the current brightness to 'target' within 'ms'
+ * milliseconds. The refresh work does the steps. Called with vfd->lock held.
+ */
+static void vfd_fade_start(struct vfd_t *vfd, u8 target, unsigned ms)
+{
+	vfd->fade_from = vfd->brightness;
+	vfd->fade_to = target;
+	vfd->fade_start = jiffies;
+	vfd->fade_len = msecs_to_jiffies(ms);
+
+	if (vfd->fade_len == 0 || target == vfd->brightness) {
+		vfd->fade_len = 0;
+		vfd->brightness = target;
+		hardware_update_brightness(vfd);
+	}
+}
+
+/* Move a running fade to the level matching the elapsed time */
+static void vfd_fade_step(struct vfd_t *vfd)
+{
+	unsigned long elapsed = jiffies - vfd->fade_start;
+	int bri;
+
+	if (elapsed >= vfd->fade_len) {
+		bri = vfd->fade_to;
+		vfd->fade_len = 0;
+	} else {
+		bri = vfd->fade_from + ((int)vfd->fade_to - vfd->fade_from) *
+			(long)elapsed / (long)vfd->fade_len;
+	}
+
+	/* only touch the chip when the level really changes */
+	if (bri != vfd->brightness) {
+		vfd->brightness = bri;
+		hardware_update_brightness(vfd);
+	}
+}
+
 //***//***//***//***//***//***// sysfs support //***//***//***//***//***//***//
 
 static ssize_t key_show(struct device *dev,
@@ -74,15 +121,21 @@ static ssize_t display_show(struct device *dev,
 	return vfd->display_len;
 }
 
-static void _display_store(struct vfd_t *vfd, const char *buf, size_t count)
+/* Called with vfd->lock held */
+static void __display_store(struct vfd_t *vfd, const char *buf, size_t count)
 {
 	size_t n = (count > vfd->display_len) ? vfd->display_len : count;
 
-	mutex_lock(&vfd->lock);
 	/* pad with spaces */
 	memset(vfd->display + n, 0, vfd->display_len - n);
 	memcpy(vfd->display, buf, n);
 	vfd->need_update = 1;
+}
+
+static void _display_store(struct vfd_t *vfd, const char *buf, size_t count)
+{
+	mutex_lock(&vfd->lock);
+	__display_store(vfd, buf, count);
 	mutex_unlock(&vfd->lock);
 }
 
@@ -102,11 +155,11 @@ static ssize_t overlay_show(struct device *dev,
 	struct vfd_t *vfd = dev_get_drvdata(dev);
 	int i;
 
-	for (i = 0; i < ARRAY_SIZE (vfd->raw_overlay); i++)
+	for (i = 0; i < vfd->raw_words; i++)
 		sprintf(buf + i * 5, "%04x ", vfd->raw_overlay [i]);
-	buf [ARRAY_SIZE (vfd->raw_overlay) * 5 - 1] = 0;
+	buf [vfd->raw_words * 5 - 1] = 0;
 
-	return ARRAY_SIZE (vfd->raw_overlay) * 5 - 1;
+	return vfd->raw_words * 5 - 1;
 }
 
 static ssize_t overlay_store(struct device *dev, struct device_attribute *attr,
@@ -119,7 +172,7 @@ static ssize_t overlay_store(struct device *dev, struct device_attribute *attr,
 	const char *cur = skip_nspaces (buf, &left);
 	u16 raw_overlay [ARRAY_SIZE (vfd->raw_overlay)];
 
-	for (i = 0; i < ARRAY_SIZE (vfd->raw_overlay); i++) {
+	for (i = 0; i < vfd->raw_words; i++) {
 		if (left <= 0)
 			break;
 
@@ -192,14 +245,58 @@ static ssize_t brightness_store(struct device *dev, struct device_attribute *att
 	const char *buf, size_t count)
 {
 	struct vfd_t *vfd = dev_get_drvdata(dev);
-	ssize_t ret = _u8_store (vfd, buf, count, &vfd->brightness, vfd->brightness_max);
-	if (ret > 0) {
-		mutex_lock(&vfd->lock);
-		hardware_update_brightness (vfd);
-		mutex_unlock(&vfd->lock);
+	unsigned value;
+
+	if (kstrtouint(skip_spaces (buf), 0, &value) != 0)
+		return -EINVAL;
+
+	if (value > vfd->brightness_max)
+		value = vfd->brightness_max;
+
+	/* an explicit level cancels any running fade, in the same locked
+	 * section so a fade step can not overwrite it */
+	mutex_lock(&vfd->lock);
+	vfd->fade_len = 0;
+	vfd->brightness = value;
+	hardware_update_brightness (vfd);
+	mutex_unlock(&vfd->lock);
+
+	return count;
+}
+
+static ssize_t brightness_fade_show(struct device *dev,
+	struct device_attribute *attr, char *buf)
+{
+	struct vfd_t *vfd = dev_get_drvdata(dev);
+	unsigned left = 0;
+
+	if (vfd->fade_len) {
+		unsigned long elapsed = jiffies - vfd->fade_start;
+		if (elapsed < vfd->fade_len)
+			left = jiffies_to_msecs(vfd->fade_len - elapsed);
+		return sprintf(buf, "%d %u\n", vfd->fade_to, left);
 	}
+	return sprintf(buf, "%d %u\n", vfd->brightness, left);
+}
 
-	return ret;
+/* "<target> <milliseconds>" : fade to target brightness */
+static ssize_t brightness_fade_store(struct device *dev, struct device_attribute *attr,
+	const char *buf, size_t count)
+{
+	struct vfd_t *vfd = dev_get_drvdata(dev);
+	unsigned target, ms;
+
+	if (sscanf(skip_spaces (buf), "%u %u", &target, &ms) != 2)
+		return -EINVAL;
+
+	if (target > vfd->brightness_max)
+		target = vfd->brightness_max;
+
+	mutex_lock(&vfd->lock);
+	vfd_fade_start(vfd, target, ms);
+	mutex_unlock(&vfd->lock);
+
+	return count;
 }
 
 static ssize_t brightness_max_show(struct device *dev,
@@ -232,8 +329,8 @@ static ssize_t dotled_show(struct device *dev,
 
 	for (i = 0; i < vfd->num_dotleds; i++) {
 		struct vfd_dotled_t *dotled = &vfd->dotleds [i];
-		int state = (vfd->raw_overlay [dotled->word] &
-			(1 << dotled->bit)) ? 1 : 0;
+		int state = ((vfd->raw_overlay [dotled->word] &
+			(1 << dotled->bit)) || test_bit (i, &vfd->led_state)) ? 1 : 0;
 		dst += sprintf(dst, "%s %d %d %d\n",
 			dotled->name, state, dotled->word, dotled->bit);
 	}
@@ -295,21 +392,233 @@ error:
 	return count;
 }
 
+//***//***//***//***//***//***// animation //***//***//***//***//***//***//
+
+/*
+ * Append a frame to the animation, starting playback if it was stopped.
+ * The anim functions are called with vfd->lock held.
+ */
+static int vfd_anim_add(struct vfd_t *vfd, const struct vfd_frame_t *fr)
+{
+	if (vfd->anim_count >= VFD_ANIM_FRAMES)
+		return -ENOSPC;
+
+	if (vfd->anim_count == 0) {
+		vfd->anim_pos = 0;
+		vfd->anim_next = jiffies;
+	}
+	vfd->anim [vfd->anim_count++] = *fr;
+
+	return 0;
+}
+
+/*
+ * Drop the frames, the text and the overlay show again in place of the
+ * last text and raw frames
+ */
+static void vfd_anim_stop(struct vfd_t *vfd)
+{
+	vfd->anim_count = 0;
+	vfd->anim_loops = 0;
+	if (vfd->anim_raw_len || vfd->anim_text_on) {
+		vfd->anim_raw_len = 0;
+		vfd->anim_text_on = 0;
+		vfd->need_update = 1;
+	}
+}
+
+/* Append a text frame */
+static void vfd_anim_add_text(struct vfd_t *vfd, const char *text, int len, unsigned ms)
+{
+	struct vfd_frame_t fr;
+
+	memset (&fr, 0, sizeof (fr));
+	fr.duration = ms;
+	fr.len = (len > vfd->display_len) ? vfd->display_len : len;
+	memcpy (fr.text, text, fr.len);
+	vfd_anim_add (vfd, &fr);
+}
+
+/* Handle one line written to the anim attribute */
+static int vfd_anim_line(struct vfd_t *vfd, const char *cur, int left)
+{
+	struct vfd_frame_t fr;
+	char cmd = *cur;
+	char *endp;
+	unsigned ms;
+
+	if (left >= 5 && strncmp (cur, "clear", 5) == 0) {
+		vfd_anim_stop (vfd);
+		return 0;
+	}
+	if (left >= 4 && strncmp (cur, "loop", 4) == 0) {
+		left -= 4;
+		cur = skip_nspaces (cur + 4, &left);
+		vfd->anim_loops = simple_strtoul (cur, NULL, 0);
+		return 0;
+	}
+
+	if ((cmd != 't' && cmd != 'r') || left < 2 || !isspace (cur [1]))
+		return -EINVAL;
+
+	left--;
+	cur = skip_nspaces (cur + 1, &left);
+	ms = simple_strtoul (cur, &endp, 0);
+	if (endp == cur)
+		return -EINVAL;
+	left -= (endp - cur);
+	cur = endp;
+
+	memset (&fr, 0, sizeof (fr));
+	fr.duration = (ms > 0xffff) ? 0xffff : ms;
+
+	if (cmd == 't') {
+		/* a single blank separates the duration from the text */
+		if (left > 0) {
+			cur++;
+			left--;
+		}
+		fr.len = (left > vfd->display_len) ? vfd->display_len : left;
+		memcpy (fr.text, cur, fr.len);
+	} else {
+		fr.is_raw = 1;
+		cur = skip_nspaces (cur, &left);
+		while (left > 0 && fr.len < vfd->raw_words) {
+			u16 n = simple_strtoul (cur, &endp, 16);
+			if (endp == cur)
+				break;
+			fr.raw [fr.len++] = n;
+			left -= (endp - cur);
+			cur = skip_nspaces (endp, &left);
+		}
+	}
+
+	return vfd_anim_add (vfd, &fr);
+}
+
+/* Show the next frame if its time has come, called from the refresh work */
+static void vfd_anim_step(struct vfd_t *vfd)
+{
+	struct vfd_frame_t *fr;
+
+	if (time_before (jiffies, vfd->anim_next))
+		return;
+
+	if (vfd->anim_pos >= vfd->anim_count) {
+		/* end of one pass */
+		vfd->anim_pos = 0;
+		if (vfd->anim_loops && --vfd->anim_loops == 0) {
+			vfd_anim_stop (vfd);
+			return;
+		}
+	}
+
+	fr = &vfd->anim [vfd->anim_pos++];
+	if (fr->is_raw) {
+		memcpy (vfd->anim_raw, fr->raw, fr->len * sizeof (u16));
+		vfd->anim_raw_len = fr->len;
+		vfd->need_update = 1;
+	} else {
+		/* padded as __display_store does */
+		memset (vfd->anim_text, 0, sizeof (vfd->anim_text));
+		memcpy (vfd->anim_text, fr->text, fr->len);
+		vfd->anim_text_on = 1;
+		vfd->need_update = 1;
+	}
+	/* at least one tick per frame, the work would spin otherwise */
+	vfd->anim_next = jiffies + (msecs_to_jiffies (fr->duration) ? : 1);
+}
+
+static ssize_t anim_show(struct device *dev,
+	struct device_attribute *attr, char *buf)
+{
+	struct vfd_t *vfd = dev_get_drvdata(dev);
+	return sprintf(buf, "%d %d %d\n", vfd->anim_count, vfd->anim_pos,
+		       vfd->anim_loops);
+}
+
+/*
+ * One command per line:
+ *   t <ms> <text>           show text during ms milliseconds
+ *   r <ms> <hex> [<hex>...] show these overlay words during ms milliseconds
+ *   loop <n>                play the frames n times, 0 loops forever
+ *   clear                   stop the animation and drop the frames
+ * The frames are a table of VFD_ANIM_FRAMES the passes replay, not a ring
+ * consumed as it plays : appending past it fails until clear. The overlay
+ * and the text written through sysfs are kept and show again once the
+ * animation stops.
+ */
+static ssize_t anim_store(struct device *dev, struct device_attribute *attr,
+	const char *buf, size_t count)
+{
+	struct vfd_t *vfd = dev_get_drvdata(dev);
+	const char *cur = buf, *end = buf + count;
+	int ret = 0;
+
+	mutex_lock(&vfd->lock);
+	while (cur < end && ret == 0) {
+		const char *eol = memchr (cur, '\n', end - cur);
+		int left;
+
+		if (! eol)
+			eol = end;
+		left = eol - cur;
+		cur = skip_nspaces (cur, &left);
+		if (left > 0)
+			ret = vfd_anim_line (vfd, cur, left);
+		cur = eol + 1;
+	}
+	mutex_unlock(&vfd->lock);
+
+	return ret < 0 ? ret : count;
+}
+
+/*
+ * Binary glyph table: one 16-bit display bitmask (host byte order) per
+ * character VFD_GLYPHS_FIRST..'~', as display_to_raw puts it in a raw word.
+ * Partial writes replace the glyphs they cover.
+ */
+static ssize_t glyphs_write(struct file *filp, struct kobject *kobj,
+	struct bin_attribute *attr, char *buf, loff_t off, size_t count)
+{
+	struct vfd_t *vfd = dev_get_drvdata(kobj_to_dev(kobj));
+	u16 image [VFD_GLYPHS_COUNT];
+	int ret;
+
+	if (! vfd->glyphs_load)
+		return -EOPNOTSUPP;
+	if ((off | count) & 1)
+		return -EINVAL;
+
+	memcpy (image, buf, count);
+
+	mutex_lock(&vfd->lock);
+	ret = vfd->glyphs_load (vfd, off / sizeof (u16), image, count / sizeof (u16));
+	vfd->need_update = 1;
+	mutex_unlock(&vfd->lock);
+
+	return ret < 0 ? ret : count;
+}
+
 static DEVICE_ATTR_RO(key);
 static DEVICE_ATTR_RW(display);
 static DEVICE_ATTR_RW(overlay);
 static DEVICE_ATTR_RW(enable);
 static DEVICE_ATTR_RW(brightness);
+static DEVICE_ATTR_RW(brightness_fade);
 static DEVICE_ATTR_RO(brightness_max);
 static DEVICE_ATTR_RW(brightness_suspend);
 static DEVICE_ATTR_RW(dotled);
+static DEVICE_ATTR_RW(anim);
 
 static const struct device_attribute *all_attrs [] = {
 	&dev_attr_key, &dev_attr_display, &dev_attr_overlay, &dev_attr_enable,
-	&dev_attr_brightness, &dev_attr_brightness_max, &dev_attr_brightness_suspend,
-	&dev_attr_dotled,
+	&dev_attr_brightness, &dev_attr_brightness_fade, &dev_attr_brightness_max,
+	&dev_attr_brightness_suspend, &dev_attr_dotled, &dev_attr_anim,
 };
 
+static BIN_ATTR_WO(glyphs, VFD_GLYPHS_COUNT * sizeof (u16));
+
 //***//***//***//***//***//***// input support //***//***//***//***//***//***//
 
 #ifndef CONFIG_VFD_NO_KEY_INPUT
@@ -365,8 +674,9 @@ static void vfd_scan_keys(struct vfd_t *vfd)
 }
 #endif
 
-//***//***//***//***//***//***// timer interrupt //***//***//***//***//***//***//
+//***//***//***//***//***//***// refresh work //***//***//***//***//***//***//
 
+/* boot animation, played from the last frame to the first */
 static char boot_anim [][4] = {
    "boot",
    "b__t",
@@ -376,19 +686,25 @@ static char boot_anim [][4] = {
    "b~~t",
 };
 
-//void vfd_timer_sr(unsigned long data)
-void vfd_timer_sr(struct timer_list *t )
+/*
+ * A work rather than a timer : the bus is bit-banged and the state is
+ * shared with the sysfs handlers under the mutex, none of it may run
+ * in softirq context. Freezable, it does not run while suspended.
+ */
+static void vfd_refresh(struct work_struct *work)
 {
-   struct vfd_t *vfd = from_timer(vfd, t, timer);
+   struct vfd_t *vfd = container_of(to_delayed_work(work), struct vfd_t, refresh);
+   unsigned long now = jiffies;
+   unsigned long next = now + msecs_to_jiffies(100);
 
 #ifndef CONFIG_VFD_NO_KEY_INPUT
    if (vfd->input)
       vfd_scan_keys(vfd);
 #endif
 
-   if (unlikely (vfd->boot_anim)) {
-      vfd->boot_anim--;
-      _display_store(vfd, boot_anim [vfd->boot_anim], 4);
+   mutex_lock(&vfd->lock);
+   if (unlikely (vfd->anim_count)) {
+      vfd_anim_step(vfd);
    }
 
    if (unlikely (vfd->need_update)) {
@@ -396,7 +712,18 @@ void vfd_timer_sr(struct timer_list *t )
       hardware_update_display (vfd);
    }
 
-   mod_timer(&vfd->timer, jiffies + msecs_to_jiffies(100));
+   if (unlikely (vfd->fade_len)) {
+      vfd_fade_step(vfd);
+   }
+
+   /* wake up earlier if the next frame is due before the next scan */
+   if (vfd->anim_count && time_before(vfd->anim_next, next)) {
+      next = vfd->anim_next;
+   }
+   mutex_unlock(&vfd->lock);
+
+   queue_delayed_work(system_freezable_wq, &vfd->refresh,
+		      time_after(next, now) ? next - now : 1);
 }
 
 //***//***//***//***// Platform device implementation //***//***//***//***//
@@ -406,12 +733,14 @@ static int __setup_gpios (struct platform_device *pdev, struct vfd_t *vfd)
 {
    int i, n, ret;
    struct gpio_desc *desc;
+   /* chips with less signals use the last ones : CLK,DI/DO */
+   int first = GPIO_MAX - vfd->ops->num_gpios;
 
-   for (i = 0; i < GPIO_MAX; i++) {
+   for (i = first; i < GPIO_MAX; i++) {
       desc = devm_gpiod_get_from_of_node(&pdev->dev, pdev->dev.of_node,
-			      "gpios", i, OF_GPIO_ACTIVE_LOW, "hq");
+			      "gpios", i - first, OF_GPIO_ACTIVE_LOW, "hq");
       if (IS_ERR(desc)) {
-	 dev_err(&pdev->dev, "%d bus signal GPIOs must be defined", GPIO_MAX);
+	 dev_err(&pdev->dev, "%d bus signal GPIOs must be defined", vfd->ops->num_gpios);
 	 return PTR_ERR (desc);
       }
 
@@ -427,10 +756,18 @@ static int __setup_gpios (struct platform_device *pdev, struct vfd_t *vfd)
       vfd->gpio_desc [i] = desc;
    }
 
-   dev_info(&pdev->dev, "bus signals STB,CLK,DI/DO mapped to GPIOs %d,%d,%d\n",
-	    desc_to_gpio(vfd->gpio_desc[GPIO_STB]),
-	    desc_to_gpio(vfd->gpio_desc[GPIO_CLK]),
-	    desc_to_gpio(vfd->gpio_desc[GPIO_DIDO]));
+   if (first == GPIO_STB) {
+      dev_info(&pdev->dev, "%s bus signals STB,CLK,DI/DO mapped to GPIOs %d,%d,%d\n",
+	       vfd->ops->name,
+	       desc_to_gpio(vfd->gpio_desc[GPIO_STB]),
+	       desc_to_gpio(vfd->gpio_desc[GPIO_CLK]),
+	       desc_to_gpio(vfd->gpio_desc[GPIO_DIDO]));
+   } else {
+      dev_info(&pdev->dev, "%s bus signals CLK,DI/DO mapped to GPIOs %d,%d\n",
+	       vfd->ops->name,
+	       desc_to_gpio(vfd->gpio_desc[GPIO_CLK]),
+	       desc_to_gpio(vfd->gpio_desc[GPIO_DIDO]));
+   }
 
    return 0;
 }
@@ -475,6 +812,76 @@ static int __setup_segment_no(struct platform_device *pdev, struct vfd_t *vfd)
    return n;
 }
 
+#if IS_REACHABLE(CONFIG_LEDS_CLASS)
+/* LED class callback, may be called from atomic context by the triggers */
+static void vfd_led_set(struct led_classdev *cdev, enum led_brightness value)
+{
+   struct vfd_dotled_t *dotled = container_of(cdev, struct vfd_dotled_t, cdev);
+   struct vfd_t *vfd = dotled->vfd;
+   int n = dotled - vfd->dotleds;
+
+   if (value){
+      set_bit(n, &vfd->led_state);
+   } else {
+      clear_bit(n, &vfd->led_state);
+   }
+   /* the refresh work sends it */
+   vfd->need_update = 1;
+}
+
+static enum led_brightness vfd_led_get(struct led_classdev *cdev)
+{
+   struct vfd_dotled_t *dotled = container_of(cdev, struct vfd_dotled_t, cdev);
+
+   return test_bit(dotled - dotled->vfd->dotleds, &dotled->vfd->led_state) ?
+      LED_ON : LED_OFF;
+}
+
+/* Register the dot LEDs as LED class devices named vfd::<dot name> */
+static void __setup_leds (struct platform_device *pdev, struct vfd_t *vfd)
+{
+   int i, ret;
+
+   for (i = 0; i < vfd->num_dotleds; i++) {
+      struct vfd_dotled_t *dotled = &vfd->dotleds [i];
+
+      dotled->vfd = vfd;
+      dotled->cdev.name = kasprintf(GFP_KERNEL, "vfd::%s", dotled->name);
+      dotled->cdev.max_brightness = LED_ON;
+      dotled->cdev.brightness_set = vfd_led_set;
+      dotled->cdev.brightness_get = vfd_led_get;
+      /* optional, one trigger name per dot_names entry */
+      of_property_read_string_index(pdev->dev.of_node, "dot_triggers",
+				    i, &dotled->cdev.default_trigger);
+
+      if ( ! dotled->cdev.name ||
+	   (ret = led_classdev_register(&pdev->dev, &dotled->cdev)) < 0) {
+	 dev_warn(&pdev->dev, "failed to register LED for dot '%s'\n", dotled->name);
+	 kfree(dotled->cdev.name);
+	 dotled->cdev.name = NULL;
+      }
+   }
+}
+
+static void __remove_leds (struct vfd_t *vfd)
+{
+   int i;
+
+   for (i = 0; i < vfd->num_dotleds; i++) {
+      struct vfd_dotled_t *dotled = &vfd->dotleds [i];
+
+      if (dotled->cdev.name) {
+	 led_classdev_unregister(&dotled->cdev);
+	 kfree(dotled->cdev.name);
+	 dotled->cdev.name = NULL;
+      }
+   }
+}
+#else
+#define __setup_leds(pdev, vfd)
+#define __remove_leds(vfd)
+#endif
+
 /* Set up dot LEDs */
 static int __setup_dotled (struct platform_device *pdev, struct vfd_t *vfd)
 {
@@ -496,8 +903,18 @@ static int __setup_dotled (struct platform_device *pdev, struct vfd_t *vfd)
 	      vfd->num_dotleds, (int)(prop->length / (2 * sizeof (u8))));
       return 0;
    }
+   /* led_state keeps one bit per dot led, the ones past it are dropped */
+   if (vfd->num_dotleds > BITS_PER_LONG) {
+      dev_warn(&pdev->dev, "%d dot leds, only the first %d are used\n",
+	       vfd->num_dotleds, BITS_PER_LONG);
+      vfd->num_dotleds = BITS_PER_LONG;
+   }
 
-   vfd->dotleds = kmalloc (vfd->num_dotleds * sizeof (struct vfd_dotled_t), GFP_KERNEL);
+   vfd->dotleds = kzalloc (vfd->num_dotleds * sizeof (struct vfd_dotled_t), GFP_KERNEL);
+   if ( ! vfd->dotleds) {
+      vfd->num_dotleds = 0;
+      return -ENOMEM;
+   }
    ptr = (u8 *)prop->value;
    for (i = 0; i < vfd->num_dotleds; i++) {
       if (of_property_read_string_index(pdev->dev.of_node, "dot_names",
@@ -510,6 +927,8 @@ static int __setup_dotled (struct platform_device *pdev, struct vfd_t *vfd)
 		 vfd->dotleds [i].name, vfd->dotleds [i].word, vfd->dotleds [i].bit);
    }
 
+   __setup_leds (pdev, vfd);
+
    return 0;
 }
 
@@ -567,6 +986,7 @@ static int vfd_probe(struct platform_device *pdev)
 {
    int i, ret;
    struct vfd_t *vfd;
+   const char *board;
 
    vfd = kzalloc(sizeof(struct vfd_t), GFP_KERNEL);
    if ( ! vfd){
@@ -575,6 +995,25 @@ static int vfd_probe(struct platform_device *pdev)
    mutex_init(&vfd->lock);
    platform_set_drvdata(pdev, vfd);
 
+   /* the board comes from the compatible string, the "board" property
+    * names one when the chip is wired in a board specific way */
+   vfd->board = of_device_get_match_data(&pdev->dev);
+   if (of_property_read_string(pdev->dev.of_node, "board", &board) == 0){
+      vfd->board = vfd_board_find(board);
+      if ( ! vfd->board){
+	 dev_err(&pdev->dev, "board '%s' is unknown or its backend is not built in\n", board);
+	 ret = -EINVAL;
+	 goto err1;
+      }
+   }
+   if ( ! vfd->board){
+      dev_err(&pdev->dev, "no board matches the device\n");
+      ret = -ENODEV;
+      goto err1;
+   }
+   vfd->ops = vfd->board->ops;
+   dev_info(&pdev->dev, "board %s\n", vfd->board->name);
+
    if ((ret = __setup_gpios (pdev, vfd)) < 0){
       goto err1;
    }
@@ -590,12 +1029,16 @@ static int vfd_probe(struct platform_device *pdev)
       goto err1;
    }
 
-   /* display boot animation */
-   vfd->boot_anim = ARRAY_SIZE (boot_anim);
+   /* display boot animation, nothing else runs yet : its first frame
+    * stays once it ends, until the text is written through sysfs */
+   __display_store(vfd, boot_anim [0], sizeof (boot_anim [0]));
+   for (i = ARRAY_SIZE (boot_anim) - 1; i >= 0; i--) {
+      vfd_anim_add_text(vfd, boot_anim [i], sizeof (boot_anim [i]), 100);
+   }
+   vfd->anim_loops = 1;
 
-//	setup_timer(&vfd->timer, vfd_timer_sr, (unsigned long)vfd);
-   timer_setup(&vfd->timer, vfd_timer_sr, 0);
-   mod_timer(&vfd->timer, jiffies+msecs_to_jiffies(100));
+   INIT_DELAYED_WORK(&vfd->refresh, vfd_refresh);
+   queue_delayed_work(system_freezable_wq, &vfd->refresh, msecs_to_jiffies(100));
 
    /* register sysfs attributes */
    for (i = 0; i < ARRAY_SIZE (all_attrs); i++){
@@ -603,6 +1046,9 @@ static int vfd_probe(struct platform_device *pdev)
 	 goto err2;
       }
    }
+   if ((ret = device_create_bin_file(&pdev->dev, &bin_attr_glyphs)) < 0){
+      goto err2;
+   }
 
    /* create the dot-LED objects */
    if ((ret =  __setup_dotled (pdev, vfd)) < 0)
@@ -622,6 +1068,10 @@ static int vfd_probe(struct platform_device *pdev)
    return 0;
 
 err2:
+   cancel_delayed_work_sync(&vfd->refresh);
+   if (vfd->dotleds)
+      __remove_leds (vfd);
+   device_remove_bin_file (&pdev->dev, &bin_attr_glyphs);
    for (i = ARRAY_SIZE (all_attrs) - 1; i >= 0; i--)
       device_remove_file (&pdev->dev, all_attrs [i]);
 err1:
@@ -642,6 +1092,10 @@ static int vfd_remove(struct platform_device *pdev)
 #endif
 
    /* unregister everything */
+   cancel_delayed_work_sync(&vfd->refresh);
+   if (vfd->dotleds)
+      __remove_leds (vfd);
+   device_remove_bin_file (&pdev->dev, &bin_attr_glyphs);
    for (i = ARRAY_SIZE (all_attrs) - 1; i >= 0; i--)
       device_remove_file (&pdev->dev, all_attrs [i]);
 
@@ -682,7 +1136,21 @@ static int vfd_power_common (struct platform_device *pdev, int suspend)
 	struct vfd_t *vfd = platform_get_drvdata(pdev);
 
 	mutex_lock(&vfd->lock);
-	hardware_suspend(vfd, suspend);
+	if (suspend) {
+		/* the refresh work is frozen, finish any fade right now */
+		if (vfd->fade_len) {
+			vfd->fade_len = 0;
+			vfd->brightness = vfd->fade_to;
+		}
+		hardware_suspend(vfd, 1);
+	} else {
+		/* fade in from the suspend level to the normal level */
+		u8 bri = vfd->fade_len ? vfd->fade_to : vfd->brightness;
+
+		vfd->brightness = vfd->brightness_suspend;
+		hardware_suspend(vfd, 0);
+		vfd_fade_start(vfd, bri, VFD_RESUME_FADE_MS);
+	}
 	mutex_unlock(&vfd->lock);
 
 	/* we only care about resume here, suspend is handled in earlysuspend */
@@ -710,12 +1178,23 @@ static void vfd_shutdown(struct platform_device *pdev)
 	vfd_power_common (pdev, 1);
 }
 
+/* only the backends built in are matched */
 static const struct of_device_id vfd_dt_match[] = {
-   {
-      .compatible     = "amlogic,aml_vfd",
-   },
+#ifdef CONFIG_VFD_PT6964
+   /* legacy name, a T95U unless the "board" property tells otherwise */
+   { .compatible = "amlogic,aml_vfd",  .data = &vfd_board_t95u },
+   { .compatible = "princeton,pt6964", .data = &vfd_board_pt6964 },
+   { .compatible = "titanmec,tm1628",  .data = &vfd_board_pt6964 },
+   { .compatible = "fdhisi,fd628",     .data = &vfd_board_pt6964 },
+   { .compatible = "fdhisi,fd620",     .data = &vfd_board_fd620 },
+#endif
+#ifdef CONFIG_VFD_FD650
+   { .compatible = "fdhisi,fd650",     .data = &vfd_board_fd650 },
+   { .compatible = "titanmec,tm1650",  .data = &vfd_board_fd650 },
+#endif
    {},
 };
+MODULE_DEVICE_TABLE(of, vfd_dt_match);
 static struct platform_driver vfd_driver = {
    .probe      = vfd_probe,
    .remove     = vfd_remove,